@@ -0,0 +1,533 @@
+#if defined(_WIN32)
+#pragma warning(disable : 4189)  // local variable is initialized but not referenced
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <numeric>
+#include <tuple>
+#include <vector>
+#include "Benchmark.h"
+#include "Chunk.h"
+#include "FileSource.h"
+#include "Filter.h"
+#include "Fusion.h"
+#include "Generate.h"
+#include "Memoize.h"
+#include "Parallel.h"
+#include "Take.h"
+#include "TopK.h"
+#include "Transform.h"
+#include "Zip.h"
+
+// Compares a hand-written loop, iteration through the nested adaptor iterators, the fused push-style
+// evaluation of Fusion.h and the parallel evaluation of Parallel.h over the same pipelines
+namespace AdaptorBenchmark {
+
+static constexpr std::size_t Elements = 16 * 1024 * 1024;
+static constexpr std::size_t Taken = Elements / 4;
+
+struct IsOdd
+{
+    bool operator()(std::uint32_t n) const { return n % 2 != 0; }
+};
+
+struct Square
+{
+    std::uint64_t operator()(std::uint32_t n) const { return std::uint64_t(n) * n; }
+};
+
+static const std::vector<std::uint32_t>& Source()
+{
+    static const std::vector<std::uint32_t> source = [] {
+        std::vector<std::uint32_t> v(Elements);
+        std::iota(v.begin(), v.end(), 0u);
+        return v;
+    }();
+    return source;
+}
+
+static const std::vector<float>& FloatSource()
+{
+    static const std::vector<float> source = [] {
+        std::vector<float> v(Elements);
+        for (std::size_t i = 0; i < Elements; ++i)
+        {
+            v[i] = static_cast<float>(i % 1000) * 0.001f;
+        }
+        return v;
+    }();
+    return source;
+}
+
+struct AboveHalf
+{
+    bool operator()(float f) const { return f > 0.5f; }
+};
+
+struct Scale
+{
+    float operator()(float f) const { return f * 2.0f + 1.0f; }
+};
+
+// v | filter(IsOdd) | transform(Square) | take(Taken), summed
+static void HandWrittenSum()
+{
+    std::uint64_t sum = 0;
+    std::size_t taken = 0;
+    for (std::uint32_t n : Source())
+    {
+        if (IsOdd()(n))
+        {
+            sum += Square()(n);
+            if (++taken == Taken)
+            {
+                break;
+            }
+        }
+    }
+    Benchmark::DoNotOptimize(sum);
+}
+
+static void NestedSum()
+{
+    using namespace Range;
+
+    std::uint64_t sum = 0;
+    for (auto n : Source() | filter(IsOdd()) | transform(Square()) | take(Taken))
+    {
+        sum += n;
+    }
+    Benchmark::DoNotOptimize(sum);
+}
+
+static void FusedSum()
+{
+    using namespace Range;
+
+    std::uint64_t sum = reduce(Source() | filter(IsOdd()) | transform(Square()) | take(Taken), std::uint64_t(0));
+    Benchmark::DoNotOptimize(sum);
+}
+
+static void HandWrittenToVector()
+{
+    std::vector<std::uint64_t> result;
+    for (std::uint32_t n : Source())
+    {
+        if (IsOdd()(n))
+        {
+            result.push_back(Square()(n));
+        }
+    }
+    Benchmark::DoNotOptimize(result.data());
+}
+
+static void NestedToVector()
+{
+    using namespace Range;
+
+    std::vector<std::uint64_t> result;
+    for (auto n : Source() | filter(IsOdd()) | transform(Square()))
+    {
+        result.push_back(n);
+    }
+    Benchmark::DoNotOptimize(result.data());
+}
+
+static void FusedToVector()
+{
+    using namespace Range;
+
+    auto result = to_vector(Source() | filter(IsOdd()) | transform(Square()));
+    Benchmark::DoNotOptimize(result.data());
+}
+
+// xorshift, so the loop cannot be folded into a closed form
+struct Random
+{
+    std::uint32_t m_nState = 2463534242u;
+    std::uint32_t operator()()
+    {
+        m_nState ^= m_nState << 13;
+        m_nState ^= m_nState >> 17;
+        m_nState ^= m_nState << 5;
+        return m_nState;
+    }
+};
+
+// generate(...) | take(n) iterated directly, the end test is the take count alone
+static void GenerateTakeSum()
+{
+    using namespace Range;
+
+    std::uint64_t sum = 0;
+    for (auto n : generate(Random()) | take(Elements))
+    {
+        sum += n;
+    }
+    Benchmark::DoNotOptimize(sum);
+}
+
+static void HandWrittenCountSum()
+{
+    std::uint64_t sum = 0;
+    Random random;
+    for (std::size_t i = 0; i < Elements; ++i)
+    {
+        sum += random();
+    }
+    Benchmark::DoNotOptimize(sum);
+}
+
+// v | transform(Square), summed one element at a time or in blocks of 256 by a kernel loop
+static void ElementSum()
+{
+    using namespace Range;
+
+    std::uint64_t sum = 0;
+    for (auto n : Source() | transform(Square()))
+    {
+        sum += n;
+    }
+    Benchmark::DoNotOptimize(sum);
+}
+
+static void ChunkSum()
+{
+    using namespace Range;
+
+    std::uint64_t sum = 0;
+    for (auto block : Source() | chunk(256))
+    {
+        for (std::uint32_t n : block)
+        {
+            sum += Square()(n);
+        }
+    }
+    Benchmark::DoNotOptimize(sum);
+}
+
+// float pipelines, Range::to_vector evaluates them in blocks and Range::reduce as one fused loop
+static void NestedFloatToVector()
+{
+    using namespace Range;
+
+    std::vector<float> result;
+    for (auto f : FloatSource() | filter(AboveHalf()) | transform(Scale()))
+    {
+        result.push_back(f);
+    }
+    Benchmark::DoNotOptimize(result.data());
+}
+
+static void BlockFloatToVector()
+{
+    using namespace Range;
+
+    auto result = to_vector(FloatSource() | filter(AboveHalf()) | transform(Scale()));
+    Benchmark::DoNotOptimize(result.data());
+}
+
+static void NestedFloatTransformToVector()
+{
+    using namespace Range;
+
+    std::vector<float> result;
+    for (auto f : FloatSource() | transform(Scale()))
+    {
+        result.push_back(f);
+    }
+    Benchmark::DoNotOptimize(result.data());
+}
+
+static void BlockFloatTransformToVector()
+{
+    using namespace Range;
+
+    auto result = to_vector(FloatSource() | transform(Scale()));
+    Benchmark::DoNotOptimize(result.data());
+}
+
+static void NestedFloatSum()
+{
+    using namespace Range;
+
+    float sum = 0.0f;
+    for (auto f : FloatSource() | transform(Scale()) | filter(AboveHalf()))
+    {
+        sum += f;
+    }
+    Benchmark::DoNotOptimize(sum);
+}
+
+static void FusedFloatSum()
+{
+    using namespace Range;
+
+    float sum = reduce(FloatSource() | transform(Scale()) | filter(AboveHalf()), 0.0f);
+    Benchmark::DoNotOptimize(sum);
+}
+
+static void ParallelSum()
+{
+    using namespace Range;
+
+    std::uint64_t sum = reduce(par, Source() | filter(IsOdd()) | transform(Square()), std::uint64_t(0));
+    Benchmark::DoNotOptimize(sum);
+}
+
+static void FusedFullSum()
+{
+    using namespace Range;
+
+    std::uint64_t sum = reduce(Source() | filter(IsOdd()) | transform(Square()), std::uint64_t(0));
+    Benchmark::DoNotOptimize(sum);
+}
+
+static void ParallelToVector()
+{
+    using namespace Range;
+
+    auto result = Source() | filter(IsOdd()) | transform(Square()) | to_vector(par);
+    Benchmark::DoNotOptimize(result.data());
+}
+
+static void PushBackCollect()
+{
+    using namespace Range;
+
+    std::vector<std::uint64_t> result;
+    for (auto n : Source() | transform(Square()) | take(Taken))
+    {
+        result.push_back(n);
+    }
+    Benchmark::DoNotOptimize(result.data());
+}
+
+static void SizedCollect()
+{
+    using namespace Range;
+
+    auto result = Source() | transform(Square()) | take(Taken) | to<std::vector>();
+    Benchmark::DoNotOptimize(result.data());
+}
+
+// Newton iterations for the square root, an operation worth computing once
+struct Expensive
+{
+    float operator()(float f) const
+    {
+        float x = f + 1.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            x = 0.5f * (x + (f + 1.0f) / x);
+        }
+        return x;
+    }
+};
+
+// the sum and the maximum of the same pipeline, two passes
+static void TwoPassTransform()
+{
+    using namespace Range;
+
+    auto pipeline = FloatSource() | transform(Expensive());
+    float sum = reduce(pipeline, 0.0f);
+    float max = reduce(pipeline, 0.0f, [](float a, float b) { return a < b ? b : a; });
+    Benchmark::DoNotOptimize(sum + max);
+}
+
+static void TwoPassMemoize()
+{
+    using namespace Range;
+
+    auto pipeline = FloatSource() | transform(Expensive()) | memoize();
+    float sum = reduce(pipeline, 0.0f);
+    float max = reduce(pipeline, 0.0f, [](float a, float b) { return a < b ? b : a; });
+    Benchmark::DoNotOptimize(sum + max);
+}
+
+struct Product
+{
+    float operator()(const std::tuple<const float&, const float&>& t) const { return std::get<0>(t) * std::get<1>(t); }
+};
+
+// dot product of FloatSource() with itself shifted by one
+static void HandWrittenDot()
+{
+    const std::vector<float>& x = FloatSource();
+    float sum = 0.0f;
+    for (std::size_t i = 0; i + 1 < x.size(); ++i)
+    {
+        sum += x[i] * x[i + 1];
+    }
+    Benchmark::DoNotOptimize(sum);
+}
+
+static void NestedDot()
+{
+    using namespace Range;
+
+    const std::vector<float>& x = FloatSource();
+    float sum = 0.0f;
+    for (auto p : zip(x, make_range(x.begin() + 1, x.end())) | transform(Product()))
+    {
+        sum += p;
+    }
+    Benchmark::DoNotOptimize(sum);
+}
+
+static void FusedDot()
+{
+    using namespace Range;
+
+    const std::vector<float>& x = FloatSource();
+    float sum = reduce(zip(x, make_range(x.begin() + 1, x.end())) | transform(Product()), 0.0f);
+    Benchmark::DoNotOptimize(sum);
+}
+
+static constexpr std::size_t FileLines = 4 * 1024 * 1024;
+
+// a log of FileLines lines, every seventh one an error
+static const std::string& LogFile()
+{
+    static const std::string path = [] {
+        const std::string p = (std::filesystem::temp_directory_path() / "AdaptorBenchmark.log").string();
+        std::ofstream file(p, std::ios::binary | std::ios::trunc);
+        for (std::size_t i = 0; i < FileLines; ++i)
+        {
+            file << "2024-01-01 00:00:00 request " << i << (i % 7 == 0 ? " ERROR\n" : " ok\n");
+        }
+        return p;
+    }();
+    return path;
+}
+
+struct IsErrorLine
+{
+    bool operator()(std::string_view line) const { return line.size() >= 5 && line.compare(line.size() - 5, 5, "ERROR") == 0; }
+};
+
+static void GetlineErrors()
+{
+    std::ifstream file(LogFile(), std::ios::binary);
+    std::size_t errors = 0;
+    for (std::string line; std::getline(file, line);)
+    {
+        errors += IsErrorLine()(line);
+    }
+    Benchmark::DoNotOptimize(errors);
+}
+
+static void MappedErrors()
+{
+    using namespace Range;
+
+    MappedFile file(LogFile().c_str());
+    std::size_t errors = reduce(lines(file) | filter(IsErrorLine()), std::size_t(0), [](std::size_t n, std::string_view) { return n + 1; });
+    Benchmark::DoNotOptimize(errors);
+}
+
+static void ReaderErrors()
+{
+    using namespace Range;
+
+    FileReader file(LogFile().c_str());
+    std::size_t errors = reduce(lines(file) | filter(IsErrorLine()), std::size_t(0), [](std::size_t n, std::string_view) { return n + 1; });
+    Benchmark::DoNotOptimize(errors);
+}
+
+// Multiplying by an odd constant permutes the 32-bit values, which scrambles the ascending source
+struct Scramble
+{
+    std::uint32_t operator()(std::uint32_t n) const { return n * 2654435761u; }
+};
+
+static constexpr std::size_t TopCount = 100;
+
+// v | transform(Scramble) | top_k(TopCount) by sorting everything and keeping the first TopCount
+static void SortTopK()
+{
+    using namespace Range;
+
+    std::vector<std::uint32_t> result = to_vector(Source() | transform(Scramble()));
+    std::sort(result.begin(), result.end(), std::greater<>());
+    result.resize(TopCount);
+    Benchmark::DoNotOptimize(result.data());
+}
+
+static void HeapTopK()
+{
+    using namespace Range;
+
+    auto result = Source() | transform(Scramble()) | top_k(TopCount);
+    Benchmark::DoNotOptimize(result.data());
+}
+
+static void ParallelTopK()
+{
+    using namespace Range;
+
+    auto result = Source() | transform(Scramble()) | top_k(par, TopCount);
+    Benchmark::DoNotOptimize(result.data());
+}
+
+}  // namespace AdaptorBenchmark
+
+void RunAdaptorBenchmark()
+{
+    using namespace AdaptorBenchmark;
+    using Benchmark::Measure;
+    using Benchmark::Report;
+
+    Source();
+    FloatSource();
+
+    Report(Measure("filter|transform|take sum", "hand-written", Elements, Taken * 2, HandWrittenSum, 5));
+    Report(Measure("filter|transform|take sum", "nested", Elements, Taken * 2, NestedSum, 5));
+    Report(Measure("filter|transform|take sum", "fused", Elements, Taken * 2, FusedSum, 5));
+
+    Report(Measure("filter|transform to_vector", "hand-written", Elements, Elements, HandWrittenToVector, 5));
+    Report(Measure("filter|transform to_vector", "nested", Elements, Elements, NestedToVector, 5));
+    Report(Measure("filter|transform to_vector", "fused", Elements, Elements, FusedToVector, 5));
+    Report(Measure("filter|transform to_vector", "parallel", Elements, Elements, ParallelToVector, 5));
+
+    Report(Measure("generate|take sum", "hand-written", Elements, Elements, HandWrittenCountSum, 5));
+    Report(Measure("generate|take sum", "nested", Elements, Elements, GenerateTakeSum, 5));
+
+    Report(Measure("float filter|transform to_vector", "nested", Elements, Elements, NestedFloatToVector, 5));
+    Report(Measure("float filter|transform to_vector", "block", Elements, Elements, BlockFloatToVector, 5));
+    Report(Measure("float transform to_vector", "nested", Elements, Elements, NestedFloatTransformToVector, 5));
+    Report(Measure("float transform to_vector", "block", Elements, Elements, BlockFloatTransformToVector, 5));
+    Report(Measure("float transform|filter sum", "nested", Elements, Elements, NestedFloatSum, 5));
+    Report(Measure("float transform|filter sum", "fused", Elements, Elements, FusedFloatSum, 5));
+
+    Report(Measure("transform sum", "element", Elements, Elements, ElementSum, 5));
+    Report(Measure("transform sum", "chunk(256)", Elements, Elements, ChunkSum, 5));
+
+    Report(Measure("filter|transform sum", "fused", Elements, Elements, FusedFullSum, 5));
+    Report(Measure("filter|transform sum", "parallel", Elements, Elements, ParallelSum, 5));
+
+    Report(Measure("transform|take collect", "push_back", Elements, Taken, PushBackCollect, 5));
+    Report(Measure("transform|take collect", "to<std::vector>", Elements, Taken, SizedCollect, 5));
+
+    Report(Measure("expensive transform two passes", "transform", Elements, Elements * 2, TwoPassTransform, 5));
+    Report(Measure("expensive transform two passes", "memoize", Elements, Elements * 2, TwoPassMemoize, 5));
+
+    Report(Measure("zip dot product", "hand-written", Elements, Elements, HandWrittenDot, 5));
+    Report(Measure("zip dot product", "nested", Elements, Elements, NestedDot, 5));
+    Report(Measure("zip dot product", "fused", Elements, Elements, FusedDot, 5));
+
+    Report(Measure("transform top_k(100)", "sort", Elements, Elements, SortTopK, 5));
+    Report(Measure("transform top_k(100)", "top_k", Elements, Elements, HeapTopK, 5));
+    Report(Measure("transform top_k(100)", "top_k(par)", Elements, Elements, ParallelTopK, 5));
+
+    LogFile();
+    Report(Measure("log file error count", "std::getline", FileLines, FileLines, GetlineErrors, 5));
+    Report(Measure("log file error count", "MappedFile lines", FileLines, FileLines, MappedErrors, 5));
+    Report(Measure("log file error count", "FileReader lines", FileLines, FileLines, ReaderErrors, 5));
+    std::filesystem::remove(LogFile());
+}
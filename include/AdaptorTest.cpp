@@ -10,17 +10,35 @@
 
 #include <Types.h>
 #include <eastl/vector.h>
+#include <algorithm>
 #include <deque>
+#include <filesystem>
 #include <forward_list>
+#include <fstream>
 #include <list>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <set>
 #include <string>
 #include <vector>
+#include "AllocationCounter.h"
+#include "Chunk.h"
+#include "FileSource.h"
 #include "Filter.h"
+#include "Fusion.h"
 #include "Generate.h"
+#include "Memoize.h"
+#include "Parallel.h"
+#include "ParallelSort.h"
 #include "Reverse.h"
+#include "Simd.h"
+#include "SizeHint.h"
 #include "Take.h"
+#include "TopK.h"
 #include "Transform.h"
 #include "Utility.h"
+#include "Zip.h"
 
 // clang-format off
 namespace AdaptorTest
@@ -384,6 +402,52 @@ static void DoTransformTestsImpl()
     DoGenericTransformTests<SequenceContainer<eastl::wstring> >();
 }
 
+static void DoTransformResultTests()
+{
+    using Range::reverse;
+    using Range::transform;
+
+    std::vector<GDK::uint32> Source{ 1, 2, 3 };
+
+    // an empty operation adds nothing to the iterator
+    static_assert(sizeof(Range::transform_iterator<const GDK::uint32*, Times3>) == sizeof(const GDK::uint32*), "transform_iterator is pointer-sized");
+
+    // results are returned by value and need no default constructor
+    auto structs = Source | transform(MakeStruct);
+    static_assert(std::is_same<decltype(*structs.begin()), MyStruct>::value, "transform returns a prvalue");
+    std::vector<MyStruct> structVector;
+    push_back(structVector, structs);
+    assert(structVector.size() == 3 && structVector[2].m_i == 3);
+
+    // move-only results are moved out
+    std::vector<std::unique_ptr<GDK::uint32> > pointers;
+    for (auto p : Source | transform([](GDK::uint32 n) { return std::make_unique<GDK::uint32>(n); }))
+    {
+        pointers.push_back(std::move(p));
+    }
+    assert(pointers.size() == 3 && *pointers[1] == 2);
+
+    // a reference returned by the operation is passed through
+    auto projected = structVector | transform([](const MyStruct& m) -> const unsigned& { return m.m_i; });
+    static_assert(std::is_same<decltype(*projected.begin()), const unsigned&>::value, "transform passes references through");
+    assert(&*projected.begin() == &structVector[0].m_i);
+
+    // reverse dereferences a temporary copy of the iterator, the result must not refer into it
+    std::vector<GDK::uint32> reversed;
+    push_back(reversed, Source | transform(Times3()) | reverse());
+    assert(reversed == make_container<std::vector<GDK::uint32> >({ 9u, 6u, 3u }));
+
+    // a mutable lambda and a function object with a non-const operator() are called through operator*
+    std::vector<GDK::uint32> numbered;
+    push_back(numbered, Source | transform([next = 0u](GDK::uint32 n) mutable { return n * 10 + next++; }));
+    assert(numbered == make_container<std::vector<GDK::uint32> >({ 10u, 21u, 32u }));
+    struct AddOne
+    {
+        GDK::uint32 operator()(GDK::uint32 n) { return n + 1; }
+    };
+    assert(Range::to_vector(Source | transform(AddOne())) == make_container<std::vector<GDK::uint32> >({ 2u, 3u, 4u }));
+}
+
 static void DoTransformTests()
 {
     DoTransformTestsImpl<eastl::vector>();
@@ -392,6 +456,7 @@ static void DoTransformTests()
     DoTransformTestsImpl<std::list>();
     DoTransformTestsImpl<std::deque>();
     DoTransformTestsImpl<std::forward_list>();
+    DoTransformResultTests();
 }
 
 static const std::vector<GDK::uint32> AllEven = { 2, 6, 12 };
@@ -844,10 +909,36 @@ static void DoGenericTakeTests()
         assert(CheckResult(destVector, Source));
     }
 
-    // Take from infinite range
+    // A take over a container is a common range, which the iterator-pair algorithms accept
+    {
+        auto r = Source | take(5);
+        assert(std::distance(r.begin(), r.end()) == 5);
+        assert(std::accumulate(r.begin(), r.end(), 0u) == 10);
+        auto t = r | transform(Times3());
+        std::vector<GDK::uint32> copy(t.begin(), t.end());
+        assert((copy == std::vector<GDK::uint32>{ 0, 3, 6, 9, 12 }));
+        auto all = Source | take(20);
+        assert(std::distance(all.begin(), all.end()) == 10);
+    }
+
+    // Take exactly as many as the range contains, then step to the end
+    {
+        auto r = Source | take(10);
+        auto it = r.begin();
+        std::advance(it, 9);
+        assert(it != r.end());
+        ++it;
+        assert(it == r.end());
+    }
+
+    // Take from infinite range, the ends carry no state
     {
         std::vector<GDK::uint32> destVector;
         auto r = generate(MakeInt()) | take(5);
+        static_assert(std::is_empty<decltype(generate(MakeInt()).end())>::value, "Expected empty generate sentinel");
+        static_assert(std::is_empty<decltype(r.end())>::value, "Expected empty take sentinel");
+        static_assert(Range::detail::is_input_iterator_type<decltype(r.begin())>::value && !Range::detail::is_input_iterator_type<GDK::uint32>::value,
+                      "only iterators compare with unreachable_sentinel");
         for (auto i : r)
         {
             destVector.push_back(i);
@@ -1035,6 +1126,797 @@ static void DoReverseTests()
     DoReverseTestsImpl<std::deque>();
 }
 
+// Adaptors are views, iterating a pipeline over an existing container must not touch the heap
+static void DoAllocationTests()
+{
+    using Range::filter;
+    using Range::generate_n;
+    using Range::reverse;
+    using Range::take;
+    using Range::transform;
+
+    std::vector<GDK::uint32> Source(100);
+    std::iota(Source.begin(), Source.end(), 0u);
+
+    AllocationCounter::ExpectNoAllocations guard("RunAdaptorTest pipelines");
+
+    GDK::uint32 sum = 0;
+    for (auto i : Source | filter(IsOdd()) | transform(Square) | take(10))
+    {
+        sum += i;
+    }
+    assert(sum == 1330);
+
+    sum = 0;
+    for (auto i : Source | reverse() | transform(Times3()) | take(3))
+    {
+        sum += i;
+    }
+    assert(sum == 3 * (99 + 98 + 97));
+
+    sum = 0;
+    for (auto i : generate_n(MakeInt(1), 4) | transform(Square))
+    {
+        sum += i;
+    }
+    assert(sum == 30);
+}
+
+// Push-style evaluation must agree with iterating the nested adaptors
+static void DoFusionTests()
+{
+    using Range::filter;
+    using Range::generate_n;
+    using Range::reverse;
+    using Range::take;
+    using Range::transform;
+
+    std::vector<GDK::uint32> Source(100);
+    std::iota(Source.begin(), Source.end(), 0u);
+
+    {
+        auto pipeline = Source | filter(IsOdd()) | transform(Square) | take(10);
+        std::vector<GDK::uint32> expected;
+        for (auto i : pipeline)
+        {
+            expected.push_back(i);
+        }
+        assert(Range::to_vector(pipeline) == expected);
+        assert(Range::reduce(pipeline, 0u) == 1330);
+    }
+
+    {
+        // take before filter counts the elements of the base, not the filtered ones
+        auto pipeline = Source | take(10) | filter(IsEven) | transform(Times3());
+        assert(Range::to_vector(pipeline) == (std::vector<GDK::uint32>{ 0, 6, 12, 18, 24 }));
+
+        GDK::uint32 count = 0;
+        Range::for_each(pipeline, [&count](GDK::uint32) { ++count; });
+        assert(count == 5);
+    }
+
+    {
+        // adaptors without a fusion stage, and take past the end of the range
+        std::list<GDK::uint32> List(Source.begin(), Source.begin() + 5);
+        assert(Range::reduce(List | reverse() | transform(Square) | take(50), 0u) == 30);
+        assert(Range::reduce(generate_n(MakeInt(1), 4) | transform(Square), 0u) == 30);
+        assert(Range::to_vector(Source | take(0)).empty());
+        assert(Range::reduce(Source | filter(IsOdd()) | take(3), 1u, [](GDK::uint32 a, GDK::uint32 b) { return a * b; }) == 15);
+    }
+
+    {
+        AllocationCounter::ExpectNoAllocations guard("Range::reduce");
+        assert(Range::reduce(Source | filter(IsOdd()) | transform(Square) | take(10), 0u) == 1330);
+    }
+}
+
+static void DoParallelTests()
+{
+    using Range::filter;
+    using Range::par;
+    using Range::take;
+    using Range::transform;
+
+    // enough elements for several chunks
+    std::vector<GDK::uint32> Source(100000);
+    std::iota(Source.begin(), Source.end(), 0u);
+
+    {
+        auto pipeline = Source | filter(IsOdd()) | transform(Times3());
+        auto expected = Range::to_vector(pipeline);
+        assert(Range::to_vector(par, pipeline) == expected);
+        assert((pipeline | Range::to_vector(par)) == expected);
+        assert(Range::reduce(par, pipeline, std::size_t(0)) == Range::reduce(pipeline, std::size_t(0)));
+    }
+
+    {
+        // results with no default constructor
+        auto structs = Range::to_vector(par, Source | transform(MakeStruct));
+        assert(structs.size() == Source.size() && structs[99999].m_i == 99999);
+
+        // a fold into another type transforms the elements to it first
+        auto One = [](GDK::uint32) { return std::size_t(1); };
+        assert(Range::reduce(par, Source | filter(IsOdd()) | transform(One), std::size_t(0), std::plus<>()) == 50000);
+    }
+
+    {
+        // a take is evaluated sequentially
+        auto pipeline = Source | filter(IsEven) | take(10);
+        assert(Range::to_vector(par, pipeline) == (std::vector<GDK::uint32>{ 0, 2, 4, 6, 8, 10, 12, 14, 16, 18 }));
+    }
+
+    {
+        // a filter that removes everything, and a range smaller than one chunk
+        assert(Range::to_vector(par, Source | filter([](GDK::uint32) { return false; })).empty());
+        std::vector<GDK::uint32> Small(Source.begin(), Source.begin() + 5);
+        assert(Range::reduce(par, Small | transform(Square), 0u) == 30);
+        assert(Range::reduce(par, Small | transform([](GDK::uint32 n) { return n + 1; }), 1u, std::multiplies<>()) == 120);
+    }
+}
+
+static void DoParallelSortTests()
+{
+    // a pool of its own, so the runs and blocks are cut for several threads whatever the hardware
+    ThreadPool pool(3);
+    std::mt19937 engine(7);
+
+    {
+        // enough elements for several runs, random, sorted, reversed and with few distinct values
+        std::vector<int> Random(200001);
+        std::generate(Random.begin(), Random.end(), [&engine] { return static_cast<int>(engine()); });
+        std::vector<int> Sorted(Random);
+        std::sort(Sorted.begin(), Sorted.end());
+        std::vector<int> Reversed(Sorted.rbegin(), Sorted.rend());
+        std::vector<int> Few(Random.size());
+        std::generate(Few.begin(), Few.end(), [&engine] { return static_cast<int>(engine() % 4) - 2; });
+
+        for (const std::vector<int>* pSource : { &Random, &Sorted, &Reversed, &Few })
+        {
+            std::vector<int> expected(*pSource);
+            std::sort(expected.begin(), expected.end());
+
+            std::vector<int> v(*pSource);
+            Range::parallel_sort(pool, v.begin(), v.end(), std::less<>());
+            assert(v == expected);
+
+            v = *pSource;
+            Range::radix_sort(pool, v.begin(), v.end());
+            assert(v == expected);
+        }
+
+        std::vector<int> v(Random);
+        Range::parallel_sort(pool, v.begin(), v.end(), std::greater<>());
+        assert(std::is_sorted(v.begin(), v.end(), std::greater<>()));
+    }
+
+    {
+        // negative floats and signed zeros
+        std::vector<float> v(100000);
+        std::uniform_real_distribution<float> distribution(-1000.0f, 1000.0f);
+        std::generate(v.begin(), v.end(), [&] { return distribution(engine); });
+        v[10] = -0.0f;
+        v[20] = 0.0f;
+        Range::radix_sort(pool, v.begin(), v.end());
+        assert(std::is_sorted(v.begin(), v.end()));
+
+        std::vector<double> d(v.rbegin(), v.rend());
+        Range::radix_sort(pool, d.begin(), d.end());
+        assert(std::is_sorted(d.begin(), d.end()));
+    }
+
+    {
+        // small keys in a wide type, the passes over the upper bytes are skipped
+        std::vector<std::uint64_t> v(100000);
+        std::generate(v.begin(), v.end(), [&engine] { return engine() % 1000; });
+        std::deque<std::uint64_t> expected(v.begin(), v.end());
+        Range::radix_sort(pool, expected.begin(), expected.end());
+        std::sort(v.begin(), v.end());
+        assert(std::equal(v.begin(), v.end(), expected.begin()));
+    }
+
+    {
+        // elements that are moved, not copied
+        std::vector<std::string> v(100000);
+        std::generate(v.begin(), v.end(), [&engine] { return std::to_string(engine()); });
+        std::vector<std::string> expected(v);
+        std::sort(expected.begin(), expected.end());
+        Range::parallel_sort(pool, v.begin(), v.end(), std::less<>());
+        assert(v == expected);
+    }
+
+    {
+        // below the parallel minimum, and on the shared pool
+        std::vector<short> v = { 3, -1, 2 };
+        Range::radix_sort(v.begin(), v.end());
+        assert((v == std::vector<short>{ -1, 2, 3 }));
+        std::vector<int> empty;
+        Range::parallel_sort(empty.begin(), empty.end());
+        Range::radix_sort(empty.begin(), empty.end());
+    }
+}
+
+static void DoTopKTests()
+{
+    using Range::filter;
+    using Range::par;
+    using Range::take;
+    using Range::top_k;
+    using Range::transform;
+
+    // a scrambled order, so the heap keeps replacing elements
+    std::vector<GDK::uint32> Source(100000);
+    std::iota(Source.begin(), Source.end(), 0u);
+    std::shuffle(Source.begin(), Source.end(), std::mt19937(3));
+
+    auto expected = [](std::vector<GDK::uint32> v, size_t k, auto comp) {
+        std::sort(v.begin(), v.end(), [&comp](GDK::uint32 lhs, GDK::uint32 rhs) { return comp(rhs, lhs); });
+        v.resize(std::min(k, v.size()));
+        return v;
+    };
+
+    {
+        auto pipeline = Source | filter(IsOdd()) | transform(Times3());
+        const std::vector<GDK::uint32> all = Range::to_vector(pipeline);
+        assert(top_k(pipeline, 10) == expected(all, 10, std::less<>()));
+        assert((pipeline | top_k(10)) == expected(all, 10, std::less<>()));
+        assert((pipeline | top_k(10, std::greater<>())) == expected(all, 10, std::greater<>()));
+        assert(top_k(par, pipeline, 100) == expected(all, 100, std::less<>()));
+        assert((pipeline | top_k(par, 100, std::greater<>())) == expected(all, 100, std::greater<>()));
+        assert(top_k(pipeline, 0).empty() && top_k(par, pipeline, 0).empty());
+    }
+
+    {
+        // more than the range holds, ties, and a take, which is evaluated sequentially
+        std::vector<GDK::uint32> Ties = { 3, 1, 3, 2, 3 };
+        assert((top_k(Ties, 10) == std::vector<GDK::uint32>{ 3, 3, 3, 2, 1 }));
+        assert((top_k(Ties, 2) == std::vector<GDK::uint32>{ 3, 3 }));
+        assert((Source | take(5) | top_k(par, 2)) == expected(std::vector<GDK::uint32>(Source.begin(), Source.begin() + 5), 2, std::less<>()));
+    }
+
+    {
+        // a single-pass source keeps only k elements
+        std::vector<std::string> Words = { "pear", "fig", "banana", "apple", "cherry" };
+        auto ByLength = [](const std::string& lhs, const std::string& rhs) { return lhs.size() < rhs.size(); };
+        auto longest = top_k(Words | filter([](const std::string& s) { return s != "banana"; }), 2, ByLength);
+        assert(longest.size() == 2 && longest[0] == "cherry" && longest[1].size() == 5);
+    }
+}
+
+static void DoChunkTests()
+{
+    using Range::chunk;
+    using Range::filter;
+    using Range::generate;
+    using Range::take;
+    using Range::transform;
+
+    std::vector<GDK::uint32> Source(10);
+    std::iota(Source.begin(), Source.end(), 0u);
+
+    {
+        // a contiguous range is chunked in place, the last chunk holds the rest
+        std::vector<size_t> sizes;
+        GDK::uint32 sum = 0;
+        for (auto block : Source | chunk(4))
+        {
+            assert(block.data() >= Source.data() && block.data() + block.size() <= Source.data() + Source.size());
+            sizes.push_back(block.size());
+            sum = std::accumulate(block.begin(), block.end(), sum);
+        }
+        assert(sizes == (std::vector<size_t>{ 4, 4, 2 }));
+        assert(sum == 45);
+
+        auto r = Source | chunk(5);
+        auto it = r.begin();
+        assert((*it)[0] == 0 && (*it).size() == 5);
+        ++it;
+        assert((*it)[0] == 5);
+        ++it;
+        assert(it == r.end());
+        DoRangeConstructibleTests(r);
+    }
+
+    {
+        // any other range is read into batches
+        std::list<GDK::uint32> List(Source.begin(), Source.end());
+        std::vector<GDK::uint32> destVector;
+        size_t batches = 0;
+        for (auto block : List | transform(Times3()) | chunk(3))
+        {
+            destVector.insert(destVector.end(), block.begin(), block.end());
+            ++batches;
+        }
+        assert(batches == 4);
+        assert(destVector == (std::vector<GDK::uint32>{ 0, 3, 6, 9, 12, 15, 18, 21, 24, 27 }));
+
+        batches = 0;
+        for (auto block : generate(MakeInt()) | filter(IsOdd()) | take(5) | chunk(2))
+        {
+            assert(block.size() == (batches < 2 ? 2u : 1u));
+            ++batches;
+        }
+        assert(batches == 3);
+
+        // building the view reads nothing, the first batch is read when iteration starts
+        size_t reads = 0;
+        auto counted = List | transform([&reads](GDK::uint32 n) {
+                           ++reads;
+                           return n;
+                       }) |
+                       chunk(4);
+        auto first = counted.begin();
+        assert(reads == 0);
+        assert((*first).size() == 4 && reads == 4);
+    }
+
+    {
+        std::vector<GDK::uint32> Empty;
+        for (auto block : Empty | chunk(4))
+        {
+            assert(false);
+        }
+        std::list<GDK::uint32> EmptyList;
+        for (auto block : EmptyList | chunk(4))
+        {
+            assert(false);
+        }
+    }
+}
+
+static void DoBlockTests()
+{
+    using Range::filter;
+    using Range::transform;
+
+    {
+        // compress keeps the flagged elements in order, on whole vectors and the tail
+        std::vector<GDK::uint32> in(37);
+        std::iota(in.begin(), in.end(), 0u);
+        bool keep[37];
+        std::vector<GDK::uint32> expected;
+        for (size_t i = 0; i < in.size(); ++i)
+        {
+            keep[i] = (i * 7) % 3 != 0;
+            if (keep[i])
+            {
+                expected.push_back(in[i]);
+            }
+        }
+        std::vector<GDK::uint32> out(in.size() + Simd::CompressPadding);
+        out.resize(Simd::Compress(in.data(), keep, in.size(), out.data()));
+        assert(out == expected);
+
+        std::vector<double> din(in.begin(), in.end());
+        std::vector<double> dout(din.size() + Simd::CompressPadding);
+        dout.resize(Simd::Compress(din.data(), keep, din.size(), dout.data()));
+        assert(dout == std::vector<double>(expected.begin(), expected.end()));
+    }
+
+    // sizes around the block size, the block path must agree with iterating the adaptors
+    for (size_t size : { 0u, 1u, 255u, 256u, 257u, 1000u })
+    {
+        std::vector<GDK::uint32> Source(size);
+        std::iota(Source.begin(), Source.end(), 0u);
+
+        auto pipeline = Source | filter(IsOdd()) | transform(Times3()) | filter(IsMultiple3());
+        std::vector<GDK::uint32> expected;
+        for (auto i : pipeline)
+        {
+            expected.push_back(i);
+        }
+        assert(Range::to_vector(pipeline) == expected);
+        assert(Range::reduce(pipeline, 0u) == std::accumulate(expected.begin(), expected.end(), 0u));
+
+        std::vector<float> Floats(Source.begin(), Source.end());
+        auto floatPipeline = Floats | transform([](float f) { return f * 0.5f; }) | filter([](float f) { return f > 10.0f; });
+        std::vector<float> floatExpected;
+        for (auto f : floatPipeline)
+        {
+            floatExpected.push_back(f);
+        }
+        assert(Range::to_vector(floatPipeline) == floatExpected);
+        assert(Range::reduce(floatPipeline, 0.0f) == std::accumulate(floatExpected.begin(), floatExpected.end(), 0.0f));
+
+        assert(Range::to_vector(Source | filter([](GDK::uint32) { return false; })).empty());
+        assert(Range::to_vector(Source | filter(IsAny())) == Source);
+    }
+}
+
+static void DoCollectTests()
+{
+    using Range::filter;
+    using Range::generate;
+    using Range::generate_n;
+    using Range::reverse;
+    using Range::take;
+    using Range::to;
+    using Range::transform;
+    using Range::detail::range_size;
+    using Range::detail::size_kind;
+
+    std::vector<GDK::uint32> Source(100);
+    std::iota(Source.begin(), Source.end(), 0u);
+    std::list<GDK::uint32> List(Source.begin(), Source.end());
+
+    // exact through transform, take and reverse, an upper bound through filter
+    assert(range_size(Source | transform(Times3())).kind == size_kind::exact);
+    assert(range_size(Source | transform(Times3())).size == 100);
+    assert(range_size(Source | take(10)).size == 10);
+    assert(range_size(Source | take(1000)).size == 100);
+    assert(range_size(Source | reverse() | transform(Times3()) | take(7)).size == 7);
+    assert(range_size(Source | filter(IsOdd())).kind == size_kind::upper_bound);
+    assert(range_size(Source | filter(IsOdd())).size == 99);  // begin is already at the first match
+    assert(range_size(Source | filter(IsOdd()) | take(10)).kind == size_kind::upper_bound);
+    assert(range_size(Source | filter(IsOdd()) | take(10)).size == 10);
+    assert(range_size(generate(MakeInt(0)) | take(5)).kind == size_kind::exact);
+    assert(range_size(generate_n(MakeInt(0), 5) | transform(Square)).size == 5);
+    assert(range_size(List).kind == size_kind::exact);
+    assert(range_size(List | transform(Times3())).kind == size_kind::unknown);
+
+    {
+        // a sized pipeline is collected with a single allocation
+        AllocationCounter::ScopedCount count;
+        auto v = Source | transform(Times3()) | take(10) | to<std::vector<GDK::uint32> >();
+        assert(count.allocations() == 1);
+        assert(v.capacity() == 10);
+        assert(v == Range::to_vector(Source | take(10) | transform(Times3())));
+    }
+
+    {
+        AllocationCounter::ScopedCount count;
+        auto v = Source | reverse() | transform(Times3()) | to<std::vector>();
+        static_assert(std::is_same<decltype(v), std::vector<GDK::uint32> >::value, "to<std::vector> deduces the value type");
+        assert(count.allocations() == 1);
+        assert(v.size() == 100 && v.capacity() == 100);
+        assert(v.front() == 297 && v.back() == 0);
+    }
+
+    {
+        // a filter does not reserve its upper bound, which would be the whole source for a selective one
+        auto v = Source | filter(IsOdd()) | to<eastl::vector<GDK::uint32> >();
+        assert(v.size() == 50 && v == Range::to_vector(Source | filter(IsOdd())));
+        auto rare = Source | filter([](GDK::uint32 n) { return n == 42; }) | to<std::vector>();
+        assert(rare.size() == 1 && rare.capacity() < 99);
+    }
+
+    {
+        auto v = generate(MakeInt(1)) | take(4) | transform(Square) | to<std::vector>();
+        assert(v.capacity() == 4);
+        assert(v == make_container<std::vector<GDK::uint32> >({ 1u, 4u, 9u, 16u }));
+    }
+
+    // containers without reserve
+    auto l = Source | filter(IsOdd()) | take(3) | to<std::list>();
+    assert(l == make_container<std::list<GDK::uint32> >({ 1u, 3u, 5u }));
+
+    auto s = List | transform([](GDK::uint32 i) { return i % 4; }) | to<std::set>();
+    assert(s == make_container<std::set<GDK::uint32> >({ 0u, 1u, 2u, 3u }));
+
+    // the block path appends to any container with a range insert
+    std::vector<float> Floats(Source.begin(), Source.end());
+    auto floats = Floats | transform([](float f) { return f * 2.0f; }) | to<eastl::vector<float> >();
+    assert(floats.size() == 100 && floats.capacity() == 100 && floats[99] == 198.0f);
+    auto dq = Range::to<std::deque>(Floats | filter([](float f) { return f < 3.0f; }));
+    assert(dq == make_container<std::deque<float> >({ 0.0f, 1.0f, 2.0f }));
+}
+
+static void DoMemoizeTests()
+{
+    using Range::filter;
+    using Range::generate;
+    using Range::memoize;
+    using Range::take;
+    using Range::transform;
+
+    std::vector<GDK::uint32> Source(10);
+    std::iota(Source.begin(), Source.end(), 0u);
+    size_t calls = 0;
+    auto counted = [&calls](GDK::uint32 n) {
+        ++calls;
+        return n * 3;
+    };
+
+    {
+        // a random-access base gets a slot per position and stays random access
+        auto memoized = Source | transform(counted) | memoize();
+        static_assert(is_random_access_iterator<decltype(memoized.begin())>::value, "memoize keeps random access");
+        assert(memoized.end() - memoized.begin() == 10);
+        assert(memoized.begin()[7] == 21 && calls == 1);
+        assert(*std::max_element(memoized.begin(), memoized.end()) == 27);
+        assert(*std::min_element(memoized.begin(), memoized.end()) == 0);
+        assert(Range::reduce(memoized, 0u) == 135);
+        assert(calls == 10);
+
+        // copies of the view share the cache
+        auto copy = memoized;
+        assert(Range::to_vector(copy | filter(IsOdd())) == make_container<std::vector<GDK::uint32> >({ 3u, 9u, 15u, 21u, 27u }));
+        assert(Range::to_vector(Range::par, memoized) == Range::to_vector(Source | transform(Times3())));
+        assert(calls == 10);
+    }
+
+    {
+        // any other base caches the prefix read so far
+        calls = 0;
+        std::list<GDK::uint32> List(Source.begin(), Source.end());
+        auto memoized = List | transform(counted) | memoize();
+        static_assert(std::is_same<std::iterator_traits<decltype(memoized.begin())>::iterator_category, std::forward_iterator_tag>::value,
+                      "memoize over a list is forward");
+        assert(*memoized.begin() == 0 && calls == 1);
+        assert(std::distance(memoized.begin(), memoized.end()) == 10);
+        assert(std::accumulate(memoized.begin(), memoized.end(), 0u) == 135);
+        assert(std::count_if(memoized.begin(), memoized.end(), IsOdd()) == 5);
+        assert(calls == 10);
+
+        std::list<GDK::uint32> Empty;
+        auto none = Empty | transform(counted) | memoize();
+        assert(none.begin() == none.end());
+    }
+
+    {
+        // reads of an unbounded base stop where the reader stops
+        calls = 0;
+        auto memoized = generate(MakeInt(0)) | transform(counted) | memoize();
+        std::vector<GDK::uint32> firsts;
+        for (auto i : memoized | take(4))
+        {
+            firsts.push_back(i);
+        }
+        for (auto i : memoized | take(3))
+        {
+            assert(i == firsts[i / 3]);
+        }
+        assert(firsts == make_container<std::vector<GDK::uint32> >({ 0u, 3u, 6u, 9u }));
+        assert(calls == 4);
+    }
+}
+
+static void DoZipTests()
+{
+    using Range::chunk;
+    using Range::enumerate;
+    using Range::filter;
+    using Range::generate;
+    using Range::memoize;
+    using Range::take;
+    using Range::transform;
+    using Range::zip;
+
+    std::vector<GDK::uint32> a{ 1, 2, 3, 4 };
+    std::vector<double> b{ 0.5, 1.5, 2.5 };
+    std::list<GDK::uint32> List{ 10, 20, 30, 40, 50 };
+
+    {
+        // random access when every range is, cut to the shortest range
+        auto zipped = zip(a, b);
+        static_assert(is_random_access_iterator<decltype(zipped.begin())>::value, "zip keeps random access");
+        assert(zipped.end() - zipped.begin() == 3);
+        assert(std::get<1>(zipped.begin()[2]) == 2.5);
+        assert(std::get<0>(*(zipped.end() - 1)) == 3);
+
+        // elements are references into the ranges
+        static_assert(std::is_same<decltype(*zipped.begin()), std::tuple<GDK::uint32&, double&> >::value, "zip yields references");
+        for (auto t : zip(a, b))
+        {
+            std::get<1>(t) *= std::get<0>(t);
+        }
+        assert(b == make_container<std::vector<double> >({ 0.5, 3.0, 7.5 }));
+
+        GDK::uint32 sum = 0;
+        for (auto [x, y] : zip(a, List))
+        {
+            sum += x * y;
+        }
+        assert(sum == 10 + 40 + 90 + 160);
+    }
+
+    {
+        // a zip with a list is forward and ends with its shortest range
+        auto zipped = zip(List, a, a);
+        static_assert(std::is_same<std::iterator_traits<decltype(zipped.begin())>::iterator_category, std::forward_iterator_tag>::value,
+                      "zip with a list is forward");
+        assert(std::distance(zipped.begin(), zipped.end()) == 4);
+    }
+
+    {
+        // a temporary view is zipped, it only holds iterators into a
+        auto zipped = zip(a, a | take(3));
+        assert(std::distance(zipped.begin(), zipped.end()) == 3);
+        auto memoized = zip(a | memoize(), a | chunk(3));
+        assert(std::distance(memoized.begin(), memoized.end()) == 2);
+        assert(std::get<0>(*memoized.begin()) == 1 && std::get<1>(*memoized.begin()).size() == 3);
+        size_t taken = 0;
+        for (auto [i, x] : enumerate(a | take(2)))
+        {
+            assert(x == a[i]);
+            ++taken;
+        }
+        assert(taken == 2);
+        GDK::uint32 sum = 0;
+        for (auto [x, y] : zip(a | transform(Times3()), List))
+        {
+            sum += x * y;
+        }
+        assert(sum == 3 * (10 + 40 + 90 + 160));
+
+        // a sentinel range among the ranges gives a zip that ends at a zip_sentinel
+        auto naturals = generate(MakeInt());
+        std::vector<GDK::uint32> pairs;
+        for (auto [n, x] : zip(naturals, a))
+        {
+            pairs.push_back(n * 10 + x);
+        }
+        assert(pairs == make_container<std::vector<GDK::uint32> >({ 1u, 12u, 23u, 34u }));
+
+        auto firstThree = naturals | take(3);
+        auto sums = Range::to_vector(zip(firstThree, List) | transform([](const auto& t) { return std::get<0>(t) + std::get<1>(t); }));
+        assert(sums == make_container<std::vector<GDK::uint32> >({ 10u, 21u, 32u }));
+
+        size_t count = 0;
+        for (auto [i, n] : enumerate(firstThree))
+        {
+            assert(n == i);
+            ++count;
+        }
+        assert(count == 3);
+    }
+
+    {
+        std::vector<std::string> Strings{ "a", "b", "c" };
+        std::vector<size_t> indices;
+        std::string joined;
+        for (auto [i, s] : Strings | enumerate())
+        {
+            indices.push_back(i);
+            joined += s;
+        }
+        assert(indices == make_container<std::vector<size_t> >({ 0u, 1u, 2u }));
+        assert(joined == "abc");
+        static_assert(std::is_same<decltype(*enumerate(Strings).begin()), std::tuple<size_t, const std::string&> >::value,
+                      "enumerate does not copy the elements");
+
+        size_t last = 0;
+        for (auto [i, n] : enumerate(List))
+        {
+            assert(n == (i + 1) * 10);
+            last = i;
+        }
+        assert(last == 4);
+    }
+
+    {
+        // zipped pipelines fuse, and split when every range is random access
+        std::vector<float> x(10000), y(10000);
+        std::iota(x.begin(), x.end(), 0.0f);
+        std::fill(y.begin(), y.end(), 2.0f);
+        auto dot = Range::reduce(zip(x, y) | transform([](const auto& t) { return std::get<0>(t) * std::get<1>(t); }), 0.0);
+        assert(dot == 9999.0 * 10000.0);
+        auto products = Range::to_vector(Range::par, zip(x, y) | transform([](const auto& t) { return std::get<0>(t) * std::get<1>(t); }));
+        assert(products.size() == 10000 && products[4321] == 8642.0f);
+
+        auto odd = Range::to_vector(enumerate(a) | filter([](const auto& t) { return std::get<0>(t) % 2 == 1; }) |
+                                    transform([](const auto& t) { return std::get<1>(t); }));
+        assert(odd == make_container<std::vector<GDK::uint32> >({ 2u, 4u }));
+    }
+}
+
+static void DoFileSourceTests()
+{
+    using Range::filter;
+    using Range::lines;
+    using Range::records;
+    using Range::take;
+    using Range::transform;
+
+    const std::string path = (std::filesystem::temp_directory_path() / "AdaptorTest.FileSource").string();
+    auto write = [&path](const std::string& contents) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << contents;
+    };
+    auto collect = [](const auto& range) {
+        std::vector<std::string> result;
+        for (auto it = range.begin(); it != range.end(); ++it)
+        {
+            result.emplace_back(*it);
+        }
+        return result;
+    };
+
+    for (const std::string contents : { "", "one", "one\n", "one\r\ntwo\n\nfour", "\n\n" })
+    {
+        write(contents);
+        std::vector<std::string> expected;
+        for (size_t first = 0; first < contents.size();)
+        {
+            size_t last = contents.find('\n', first);
+            last = last == std::string::npos ? contents.size() : last;
+            std::string line = contents.substr(first, last - first);
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            expected.push_back(line);
+            first = last + 1;
+        }
+
+        Range::MappedFile mapped(path.c_str());
+        assert(collect(lines(mapped)) == expected);
+
+        // a buffer smaller than a line grows to hold it
+        Range::FileReader reader(path.c_str(), 2);
+        assert(collect(lines(reader)) == expected);
+    }
+
+    {
+        std::string contents;
+        for (GDK::uint32 i = 0; i < 10000; ++i)
+        {
+            contents += "line " + std::to_string(i) + (i % 7 == 0 ? " ERROR\n" : "\n");
+        }
+        write(contents);
+
+        // reading allocates nothing beyond the reader's buffer
+        auto IsError = [](std::string_view line) { return line.size() >= 5 && line.substr(line.size() - 5) == "ERROR"; };
+        auto Length = [](std::string_view line) { return line.size(); };
+        Range::MappedFile mapped(path.c_str());
+        Range::FileReader reader(path.c_str(), 4096);
+        {
+            AllocationCounter::ExpectNoAllocations guard("file source pipelines");
+            assert(Range::reduce(lines(mapped) | filter(IsError), size_t(0), [](size_t n, std::string_view) { return n + 1; }) == 1429);
+            assert(Range::reduce(lines(reader) | filter(IsError) | transform(Length) | take(2), size_t(0)) == 12 + 12);
+        }
+    }
+
+    {
+        struct Record
+        {
+            GDK::uint32 m_Id;
+            float m_Value;
+        };
+        std::vector<Record> Records;
+        for (GDK::uint32 i = 0; i < 1000; ++i)
+        {
+            Records.push_back(Record{ i, i * 0.5f });
+        }
+        std::string contents(reinterpret_cast<const char*>(Records.data()), Records.size() * sizeof(Record));
+        write(contents + "xyz");  // a partial record at the end is dropped
+
+        Range::MappedFile mapped(path.c_str());
+        auto view = records<Record>(mapped);
+        assert(view.end() - view.begin() == 1000);
+        assert(Range::reduce(view | transform([](const Record& r) { return r.m_Id; }), 0u) == 999 * 1000 / 2);
+
+        size_t count = 0;
+        for (auto record : records(mapped, sizeof(Record)))
+        {
+            assert(record.size() == sizeof(Record) && std::memcmp(record.data(), &Records[count], sizeof(Record)) == 0);
+            ++count;
+        }
+        assert(count == 1000);
+
+        Range::FileReader reader(path.c_str(), 100);
+        count = 0;
+        for (auto record : records(reader, sizeof(Record)))
+        {
+            assert(std::memcmp(record.data(), &Records[count], sizeof(Record)) == 0);
+            ++count;
+        }
+        assert(count == 1000);
+    }
+
+    std::filesystem::remove(path);
+
+    bool threw = false;
+    try
+    {
+        Range::MappedFile missing(path.c_str());
+    }
+    catch (const std::system_error&)
+    {
+        threw = true;
+    }
+    assert(threw);
+}
+
 void RunAdaptorTest()
 {
     DoReverseTests();
@@ -1044,6 +1926,17 @@ void RunAdaptorTest()
     DoTransformTests();
     DoFilterTests();
     DoFilterIteratorTests();
+    DoAllocationTests();
+    DoFusionTests();
+    DoParallelTests();
+    DoParallelSortTests();
+    DoTopKTests();
+    DoChunkTests();
+    DoBlockTests();
+    DoCollectTests();
+    DoMemoizeTests();
+    DoZipTests();
+    DoFileSourceTests();
 }
 
 // clang-format off
@@ -0,0 +1,143 @@
+// Replaces the global operator new and delete to count heap allocations per thread, see AllocationCounter.h
+// Link into test and benchmark programs only, the replacement forwards to malloc and free
+
+#include <cstdlib>
+#include <new>
+#include "AllocationCounter.h"
+
+namespace {
+
+[[maybe_unused]] const bool s_bInstalled = (AllocationCounter::Installed() = true);
+
+void* CountedAllocate(std::size_t n)
+{
+    auto& counts = AllocationCounter::ThreadCounts();
+    ++counts.allocations;
+    counts.bytes += n;
+    return std::malloc(n ? n : 1);
+}
+
+void* CountedAllocate(std::size_t n, std::size_t alignment)
+{
+    auto& counts = AllocationCounter::ThreadCounts();
+    ++counts.allocations;
+    counts.bytes += n;
+#if defined(_WIN32)
+    return _aligned_malloc(n ? n : 1, alignment);
+#else
+    // aligned_alloc requires the size to be a multiple of the alignment
+    return std::aligned_alloc(alignment, ((n ? n : 1) + alignment - 1) & ~(alignment - 1));
+#endif
+}
+
+void CountedFree(void* p) noexcept
+{
+    if (p)
+    {
+        ++AllocationCounter::ThreadCounts().deallocations;
+        std::free(p);
+    }
+}
+
+void CountedAlignedFree(void* p) noexcept
+{
+    if (p)
+    {
+        ++AllocationCounter::ThreadCounts().deallocations;
+#if defined(_WIN32)
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+}
+
+}  // namespace
+
+void* operator new(std::size_t n)
+{
+    if (void* p = CountedAllocate(n))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n)
+{
+    return ::operator new(n);
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(n);
+}
+
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(n);
+}
+
+void* operator new(std::size_t n, std::align_val_t alignment)
+{
+    if (void* p = CountedAllocate(n, static_cast<std::size_t>(alignment)))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n, std::align_val_t alignment)
+{
+    return ::operator new(n, alignment);
+}
+
+void operator delete(void* p) noexcept
+{
+    CountedFree(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    CountedFree(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    CountedFree(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    CountedFree(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    CountedFree(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    CountedFree(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    CountedAlignedFree(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    CountedAlignedFree(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    CountedAlignedFree(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+    CountedAlignedFree(p);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+
+// Counts the global operator new and delete calls made by the current thread
+// The counts only advance in programs that link AllocationCounter.cpp, which replaces the global operators
+// clang-format off
+namespace AllocationCounter
+{
+// clang-format on
+
+struct Counts
+{
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+    std::size_t bytes = 0;
+};
+
+// Counts of the calling thread, constant initialized so the first use cannot itself allocate
+inline Counts& ThreadCounts() noexcept
+{
+    static thread_local Counts counts;
+    return counts;
+}
+
+// Set by AllocationCounter.cpp when its replacement operators are linked in
+inline bool& Installed() noexcept
+{
+    static bool installed = false;
+    return installed;
+}
+
+// Counts the allocations made by the current thread from construction to the point of query
+class ScopedCount
+{
+public:
+    ScopedCount() noexcept
+        : m_Start(ThreadCounts())
+    {
+    }
+
+    std::size_t allocations() const noexcept { return ThreadCounts().allocations - m_Start.allocations; }
+    std::size_t deallocations() const noexcept { return ThreadCounts().deallocations - m_Start.deallocations; }
+    std::size_t bytes() const noexcept { return ThreadCounts().bytes - m_Start.bytes; }
+
+private:
+    Counts m_Start;
+};
+
+// Asserts that the enclosing scope performs no heap allocation on the current thread
+// Without AllocationCounter.cpp nothing is counted, the guard traces that and checks nothing
+class ExpectNoAllocations
+{
+public:
+    explicit ExpectNoAllocations(const char* name) noexcept
+        : m_sName(name)
+    {
+    }
+
+    ~ExpectNoAllocations()
+    {
+        if (!Installed())
+        {
+            Mercury::Trace("%s: allocations are not counted, link AllocationCounter.cpp\n", m_sName);
+            return;
+        }
+        if (m_Count.allocations() != 0)
+        {
+            Mercury::Trace("%s: %zu unexpected heap allocations (%zu bytes)\n", m_sName, m_Count.allocations(), m_Count.bytes());
+        }
+        assert(m_Count.allocations() == 0 && "unexpected heap allocation");
+    }
+
+    ExpectNoAllocations(const ExpectNoAllocations&) = delete;
+    ExpectNoAllocations& operator=(const ExpectNoAllocations&) = delete;
+
+private:
+    const char* m_sName;
+    ScopedCount m_Count;
+};
+
+}  // namespace AllocationCounter
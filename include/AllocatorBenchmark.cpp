@@ -0,0 +1,299 @@
+#if defined(_WIN32)
+#pragma warning(disable : 4189)  // local variable is initialized but not referenced
+#endif
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AllocationCounter.h"
+#include "Arena.h"
+#include "Benchmark.h"
+#include "MyAlloc.h"
+#include "MyMap.h"
+#include "ShortAlloc.h"
+
+// Compares the arena allocators with each other and with the system allocator
+// Each result is one JSON line, the suite names the workload and the name the allocator
+// Link AllocationCounter.cpp to report the heap bytes taken by the system allocator and MonotonicAllocator
+namespace AllocatorBenchmark {
+
+// bytes of arena per element, enough for the abandoned buffers of a growing std::vector
+static constexpr std::size_t ArenaBytesPerElement = 128;
+
+static constexpr std::size_t ThreadAllocations = 100000;
+static constexpr std::size_t ThreadArenaSize = 4 * ThreadAllocations * 64;
+
+struct Block
+{
+    char m_Data[32];
+};
+
+// xorshift, cheap enough not to dominate the allocations being measured
+static std::uint64_t NextRandom(std::uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// An allocator under test, make<T>() returns an allocator of T and bytes() the memory taken so far
+// A context is created inside the timed region, so an arena is charged for setting up its buffer
+class SystemContext
+{
+public:
+    static const char* name() { return "std::allocator"; }
+
+    template <class T>
+    using allocator = std::allocator<T>;
+
+    template <class T>
+    allocator<T> make() const
+    {
+        return allocator<T>();
+    }
+
+    std::size_t bytes() const { return m_Count.bytes(); }
+
+private:
+    AllocationCounter::ScopedCount m_Count;
+};
+
+template <class Arena, const char* (*Name)()>
+class ArenaContext
+{
+public:
+    static const char* name() { return Name(); }
+
+    template <class T>
+    using allocator = LocalAllocator<T, 0, Arena>;
+
+    template <class T>
+    allocator<T> make() const
+    {
+        return allocator<T>(*m_pArena);
+    }
+
+    std::size_t bytes() const { return m_pArena->used(); }
+
+private:
+    // the larger arenas do not fit on the stack, StackArena is measured with its buffer inside a heap object
+    std::unique_ptr<Arena> m_pArena = std::make_unique<Arena>();
+};
+
+template <std::size_t Elements>
+class MonotonicContext
+{
+public:
+    static const char* name() { return "MonotonicAllocator"; }
+
+    template <class T>
+    using allocator = MonotonicAllocator<T, 4 * Elements>;
+
+    template <class T>
+    allocator<T> make() const
+    {
+        return allocator<T>(m_Alloc);
+    }
+
+    std::size_t bytes() const { return m_Alloc.arena() ? m_Alloc.arena()->used() : 0; }
+
+private:
+    allocator<char> m_Alloc;
+};
+
+static const char* StackArenaName() { return "StackArena"; }
+static const char* HeapArenaName() { return "HeapArena"; }
+static const char* ShortAllocName() { return "short_alloc"; }
+static const char* HeapPoolName() { return "HeapPool"; }
+
+// Allocate Elements blocks, then free them newest first
+template <class Context, std::size_t Elements>
+static void AllocFree(std::size_t& bytes)
+{
+    Context context;
+    auto alloc = context.template make<Block>();
+    using Traits = std::allocator_traits<decltype(alloc)>;
+
+    Block* blocks[Elements];
+    for (std::size_t i = 0; i < Elements; ++i)
+    {
+        blocks[i] = Traits::allocate(alloc, 1);
+    }
+    bytes = context.bytes();
+    for (std::size_t i = Elements; i-- > 0;)
+    {
+        Traits::deallocate(alloc, blocks[i], 1);
+    }
+}
+
+template <class Context, std::size_t Elements>
+static void VectorBuild(std::size_t& bytes)
+{
+    Context context;
+    {
+        std::vector<int, typename Context::template allocator<int> > v(context.template make<int>());
+        for (std::size_t i = 0; i < Elements; ++i)
+        {
+            v.push_back(static_cast<int>(i));
+        }
+        Benchmark::DoNotOptimize(v.back());
+        bytes = context.bytes();
+    }
+}
+
+template <class Context, std::size_t Elements>
+static void MapBuild(std::size_t& bytes)
+{
+    using Alloc = typename Context::template allocator<std::pair<const std::uint64_t, std::uint64_t> >;
+
+    Context context;
+    {
+        std::map<std::uint64_t, std::uint64_t, std::less<std::uint64_t>, Alloc> m(context.template make<std::pair<const std::uint64_t, std::uint64_t> >());
+        std::uint64_t state = 88172645463325252ull;
+        for (std::size_t i = 0; i < Elements; ++i)
+        {
+            m.emplace(NextRandom(state), i);
+        }
+        Benchmark::DoNotOptimize(m.size());
+        bytes = context.bytes();
+    }
+}
+
+template <class Context, std::size_t Elements>
+static void StringBuild(std::size_t& bytes)
+{
+    using String = std::basic_string<char, std::char_traits<char>, typename Context::template allocator<char> >;
+
+    Context context;
+    {
+        String s(context.template make<char>());
+        for (std::size_t i = 0; i < Elements; ++i)
+        {
+            s.push_back(static_cast<char>('a' + i % 26));
+        }
+        Benchmark::DoNotOptimize(s.back());
+        bytes = context.bytes();
+    }
+}
+
+template <class Context, std::size_t Elements>
+static void ListBuild(std::size_t& bytes)
+{
+    Context context;
+    {
+        std::list<int, typename Context::template allocator<int> > l(context.template make<int>());
+        for (std::size_t i = 0; i < Elements; ++i)
+        {
+            l.push_back(static_cast<int>(i));
+        }
+        Benchmark::DoNotOptimize(l.back());
+        bytes = context.bytes();
+    }
+}
+
+template <void (*Workload)(std::size_t&)>
+static void Run(const char* suite, const char* name, std::size_t elements)
+{
+    std::size_t bytes = 0;
+    Benchmark::Result r = Benchmark::Measure(suite, name, elements, elements, [&bytes] { Workload(bytes); });
+    r.bytes = bytes;
+    Benchmark::Report(r);
+}
+
+template <class Context, std::size_t Elements>
+static void RunContext()
+{
+    Run<AllocFree<Context, Elements> >("alloc_free", Context::name(), Elements);
+    Run<VectorBuild<Context, Elements> >("vector", Context::name(), Elements);
+    Run<MapBuild<Context, Elements> >("map", Context::name(), Elements);
+    Run<StringBuild<Context, Elements> >("string", Context::name(), Elements);
+    Run<ListBuild<Context, Elements> >("list", Context::name(), Elements);
+}
+
+template <std::size_t Elements>
+static void RunSize()
+{
+    constexpr std::size_t Bytes = Elements * ArenaBytesPerElement;
+
+    RunContext<SystemContext, Elements>();
+    RunContext<ArenaContext<StackArena<Bytes>, StackArenaName>, Elements>();
+    RunContext<ArenaContext<HeapArena<Bytes>, HeapArenaName>, Elements>();
+    RunContext<ArenaContext<arena<Bytes>, ShortAllocName>, Elements>();
+    RunContext<ArenaContext<HeapPool<Bytes>, HeapPoolName>, Elements>();
+    RunContext<MonotonicContext<Elements>, Elements>();
+}
+
+// Threads allocate and free blocks at the same time, from the system allocator or from one shared arena
+template <class Alloc>
+static void ThreadWork(Alloc alloc)
+{
+    using Traits = std::allocator_traits<Alloc>;
+    std::vector<Block*> blocks(ThreadAllocations);
+    for (auto& p : blocks)
+    {
+        p = Traits::allocate(alloc, 1);
+    }
+    for (auto it = blocks.rbegin(); it != blocks.rend(); ++it)
+    {
+        Traits::deallocate(alloc, *it, 1);
+    }
+}
+
+template <class Arena>
+static void Contention(std::size_t threads)
+{
+    std::unique_ptr<Arena> pArena = std::make_unique<Arena>();
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        workers.emplace_back(ThreadWork<LocalAllocator<Block, 0, Arena> >, LocalAllocator<Block, 0, Arena>(*pArena));
+    }
+    for (auto& t : workers)
+    {
+        t.join();
+    }
+}
+
+static void SystemContention(std::size_t threads)
+{
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        workers.emplace_back(ThreadWork<std::allocator<Block> >, std::allocator<Block>());
+    }
+    for (auto& t : workers)
+    {
+        t.join();
+    }
+}
+
+static void RunContention(const char* suite, std::size_t threads)
+{
+    using Benchmark::Measure;
+    using Benchmark::Report;
+
+    const std::size_t operations = threads * ThreadAllocations;
+    Report(Measure(suite, "std::allocator", ThreadAllocations, operations, [threads] { SystemContention(threads); }));
+    Report(Measure(suite, "SpinLocked", ThreadAllocations, operations,
+                   [threads] { Contention<SharedHeapArena<ThreadArenaSize, SpinLocked> >(threads); }));
+    Report(Measure(suite, "MutexLocked", ThreadAllocations, operations,
+                   [threads] { Contention<SharedHeapArena<ThreadArenaSize, MutexLocked> >(threads); }));
+}
+
+}  // namespace AllocatorBenchmark
+
+void RunAllocatorBenchmark()
+{
+    AllocatorBenchmark::RunSize<64>();
+    AllocatorBenchmark::RunSize<1024>();
+    AllocatorBenchmark::RunSize<16384>();
+
+    AllocatorBenchmark::RunContention("contention/1", 1);
+    AllocatorBenchmark::RunContention("contention/2", 2);
+    AllocatorBenchmark::RunContention("contention/4", 4);
+}
@@ -0,0 +1,455 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+#include "ArenaStats.h"
+
+// Allocator framework: a BasicArena bump-allocates from the bytes of a storage policy, asks a fallback
+// policy when they run out, and guards its state with a thread policy. LocalAllocator adapts any arena
+// to the standard allocator interface, so the storage of a container is chosen by its arena type
+
+// every allocation starts on this boundary by default, so containers of different element types can
+// share an arena, as nested containers under std::scoped_allocator_adaptor do
+static constexpr std::size_t arena_alignment = alignof(std::max_align_t);
+
+inline std::size_t arena_align_up(std::size_t n, std::size_t alignment = arena_alignment) noexcept
+{
+    return (n + (alignment - 1)) & ~(alignment - 1);
+}
+
+// Storage policies
+// A storage policy owns the bytes of an arena and provides data(), size() and alignment
+// commit(used) is called before the first used bytes are handed out and returns false when the memory
+// cannot be provided, decommit() is called when the arena is reset
+
+// N bytes inside the arena object, on the stack for a local arena
+template <std::size_t N, std::size_t Align = arena_alignment>
+class StackStorage
+{
+public:
+    static constexpr std::size_t alignment = Align;
+
+    static constexpr std::size_t size() noexcept { return N; }
+    std::uint8_t* data() noexcept { return m_Buffer; }
+    const std::uint8_t* data() const noexcept { return m_Buffer; }
+
+    bool commit(std::size_t) noexcept { return true; }
+    void decommit() noexcept {}
+
+private:
+    alignas(Align) std::uint8_t m_Buffer[N];
+};
+
+// N bytes allocated from the heap when the arena is constructed
+template <std::size_t N>
+class HeapStorage
+{
+public:
+    static constexpr std::size_t alignment = arena_alignment;
+
+    HeapStorage()
+        : m_pBuffer(static_cast<std::uint8_t*>(::operator new(N)))
+    {
+    }
+    ~HeapStorage() { ::operator delete(m_pBuffer); }
+    HeapStorage(const HeapStorage&) = delete;
+    HeapStorage& operator=(const HeapStorage&) = delete;
+
+    static constexpr std::size_t size() noexcept { return N; }
+    std::uint8_t* data() noexcept { return m_pBuffer; }
+    const std::uint8_t* data() const noexcept { return m_pBuffer; }
+
+    bool commit(std::size_t) noexcept { return true; }
+    void decommit() noexcept {}
+
+private:
+    std::uint8_t* m_pBuffer;
+};
+
+// Heap storage whose size is chosen at run time
+class DynamicHeapStorage
+{
+public:
+    static constexpr std::size_t alignment = arena_alignment;
+
+    explicit DynamicHeapStorage(std::size_t n)
+        : m_pBuffer(static_cast<std::uint8_t*>(::operator new(n)))
+        , m_nSize(n)
+    {
+    }
+    ~DynamicHeapStorage() { ::operator delete(m_pBuffer); }
+    DynamicHeapStorage(const DynamicHeapStorage&) = delete;
+    DynamicHeapStorage& operator=(const DynamicHeapStorage&) = delete;
+
+    std::size_t size() const noexcept { return m_nSize; }
+    std::uint8_t* data() noexcept { return m_pBuffer; }
+    const std::uint8_t* data() const noexcept { return m_pBuffer; }
+
+    bool commit(std::size_t) noexcept { return true; }
+    void decommit() noexcept {}
+
+private:
+    std::uint8_t* m_pBuffer;
+    std::size_t m_nSize;
+};
+
+// Fallback policies, used when an allocation does not fit in the storage
+
+// throw std::bad_alloc, the arena never hands out memory it does not own
+struct ThrowOnExhaust
+{
+    static constexpr bool uses_heap = false;
+
+    static void* allocate(std::size_t) { throw std::bad_alloc(); }
+    static void deallocate(void*, std::size_t) noexcept { assert(false && "pointer was not allocated from this arena"); }
+};
+
+// allocate from the heap, as short_alloc does
+struct HeapFallback
+{
+    static constexpr bool uses_heap = true;
+
+    static void* allocate(std::size_t n) { return ::operator new(n); }
+    static void deallocate(void* p, std::size_t) noexcept { ::operator delete(p); }
+};
+
+// Thread policies, lockable types guarding the arena state
+
+// no locking, an arena used by one thread at a time
+struct SingleThreaded
+{
+    void lock() noexcept {}
+    void unlock() noexcept {}
+};
+
+// std::mutex, for arenas shared by threads that allocate in long bursts
+class MutexLocked
+{
+public:
+    void lock() { m_Mutex.lock(); }
+    void unlock() noexcept { m_Mutex.unlock(); }
+
+private:
+    std::mutex m_Mutex;
+};
+
+// spin lock, for arenas shared by threads where the critical section is a pointer bump
+class SpinLocked
+{
+public:
+    void lock() noexcept
+    {
+        while (m_Flag.test_and_set(std::memory_order_acquire))
+        {
+        }
+    }
+    void unlock() noexcept { m_Flag.clear(std::memory_order_release); }
+
+private:
+    std::atomic_flag m_Flag = ATOMIC_FLAG_INIT;
+};
+
+// Monotonic arena over a storage policy
+// Every allocation starts on an alignment boundary. deallocate() takes back the most recent allocation
+// and try_expand() grows it in place, anything else is released by reset(), rewind() or the destructor
+template <class Storage, class Fallback = ThrowOnExhaust, class Thread = SingleThreaded>
+class BasicArena : public ArenaStatsRecorder
+{
+public:
+    using value_type = std::uint8_t;
+    using storage_type = Storage;
+    using fallback_type = Fallback;
+    using thread_type = Thread;
+
+    static constexpr std::size_t alignment = Storage::alignment;
+
+    static_assert((alignment & (alignment - 1)) == 0, "alignment must be a power of two");
+    static_assert(!Fallback::uses_heap || alignment <= alignof(std::max_align_t),
+                  "an alignment larger than alignof(std::max_align_t) cannot be guaranteed by the heap fallback");
+
+    // any arguments are passed to the storage
+    BasicArena() = default;
+    template <class Arg, class... Args>
+    explicit BasicArena(Arg&& arg, Args&&... args)
+        : m_Storage(std::forward<Arg>(arg), std::forward<Args>(args)...)
+    {
+    }
+    BasicArena(const BasicArena&) = delete;
+    BasicArena& operator=(const BasicArena&) = delete;
+
+    std::size_t size() const noexcept { return m_Storage.size(); }
+    std::size_t used() const noexcept { return m_nUsed; }
+
+    bool owns(const void* p) const noexcept { return m_Storage.data() <= p && p < m_Storage.data() + size(); }
+
+    Storage& storage() noexcept { return m_Storage; }
+    const Storage& storage() const noexcept { return m_Storage; }
+
+    value_type* allocate(std::size_t n)
+    {
+        {
+            std::lock_guard<Thread> lock(m_Lock);
+            const std::size_t start = arena_align_up(m_nUsed, alignment);
+            if (start <= size() && n <= size() - start && m_Storage.commit(start + n))
+            {
+                m_nUsed = start + n;
+                on_allocate(n, m_nUsed);
+                return m_Storage.data() + start;
+            }
+
+            if (Fallback::uses_heap)
+            {
+                on_heap_fallback(n);
+            }
+            else
+            {
+                on_failure(n);
+            }
+        }
+        return static_cast<value_type*>(Fallback::allocate(n));
+    }
+
+    void deallocate(value_type* p, std::size_t n)
+    {
+        if (!owns(p))
+        {
+            Fallback::deallocate(p, n);
+            std::lock_guard<Thread> lock(m_Lock);
+            on_deallocate(n);
+            return;
+        }
+
+        std::lock_guard<Thread> lock(m_Lock);
+        on_deallocate(n);
+        if (p + n == m_Storage.data() + m_nUsed)
+        {
+            m_nUsed = static_cast<std::size_t>(p - m_Storage.data());
+        }
+    }
+
+    // Grow the most recent allocation in place from oldSize to newSize bytes
+    // Returns false when p is not the last allocation or the storage is too small, the caller then allocates a new block
+    bool try_expand(value_type* p, std::size_t oldSize, std::size_t newSize)
+    {
+        assert(newSize >= oldSize);
+        if (!owns(p))
+        {
+            return false;
+        }
+
+        std::lock_guard<Thread> lock(m_Lock);
+        const std::size_t start = static_cast<std::size_t>(p - m_Storage.data());
+        if (start + oldSize != m_nUsed || newSize > size() - start || !m_Storage.commit(start + newSize))
+        {
+            return false;
+        }
+        m_nUsed = start + newSize;
+        on_expand(newSize - oldSize, m_nUsed);
+        return true;
+    }
+
+    // Release every allocation at once, nothing is destroyed
+    void reset() noexcept
+    {
+        std::lock_guard<Thread> lock(m_Lock);
+        m_Storage.decommit();
+        m_nUsed = 0;
+    }
+
+    // Position of the bump pointer, rewinding to a marker releases everything allocated after it
+    using marker = std::size_t;
+    marker mark() const noexcept { return m_nUsed; }
+    void rewind(marker m) noexcept
+    {
+        std::lock_guard<Thread> lock(m_Lock);
+        assert(m <= m_nUsed && "arena rewound past its current position");
+        m_nUsed = m;
+    }
+
+private:
+    Storage m_Storage;
+    std::size_t m_nUsed = 0;
+    Thread m_Lock;
+};
+
+// Pool of fixed-size blocks carved from a BasicArena, for node containers such as std::map and std::list
+// Requests of up to BlockSize bytes take a block, freed blocks go on a free list and are reused, so a
+// container that inserts and erases keeps reusing the same memory. Larger requests go to the arena
+template <class Storage, std::size_t BlockSize, class Fallback = ThrowOnExhaust, class Thread = SingleThreaded>
+class BasicPool : public ArenaStatsRecorder
+{
+public:
+    using value_type = std::uint8_t;
+    using arena_type = BasicArena<Storage, Fallback, SingleThreaded>;
+
+    static constexpr std::size_t alignment = arena_type::alignment;
+    static constexpr std::size_t block_size = (BlockSize < sizeof(void*) ? sizeof(void*) : BlockSize);
+
+    BasicPool() = default;
+    template <class Arg, class... Args>
+    explicit BasicPool(Arg&& arg, Args&&... args)
+        : m_Arena(std::forward<Arg>(arg), std::forward<Args>(args)...)
+    {
+    }
+    BasicPool(const BasicPool&) = delete;
+    BasicPool& operator=(const BasicPool&) = delete;
+
+    std::size_t size() const noexcept { return m_Arena.size(); }
+    std::size_t used() const noexcept { return m_Arena.used(); }
+    bool owns(const void* p) const noexcept { return m_Arena.owns(p); }
+
+    value_type* allocate(std::size_t n)
+    {
+        std::lock_guard<Thread> lock(m_Lock);
+        value_type* p;
+        if (n <= block_size && m_pFreeList)
+        {
+            p = reinterpret_cast<value_type*>(m_pFreeList);
+            m_pFreeList = m_pFreeList->m_pNext;
+        }
+        else
+        {
+            p = m_Arena.allocate(n <= block_size ? block_size : n);
+        }
+        on_allocate(n, m_Arena.used());
+        return p;
+    }
+
+    void deallocate(value_type* p, std::size_t n)
+    {
+        std::lock_guard<Thread> lock(m_Lock);
+        on_deallocate(n);
+        if (n <= block_size && m_Arena.owns(p))
+        {
+            m_pFreeList = ::new (static_cast<void*>(p)) FreeBlock{ m_pFreeList };
+        }
+        else
+        {
+            m_Arena.deallocate(p, n);
+        }
+    }
+
+    bool try_expand(value_type* p, std::size_t oldSize, std::size_t newSize)
+    {
+        std::lock_guard<Thread> lock(m_Lock);
+        return oldSize > block_size && m_Arena.try_expand(p, oldSize, newSize);
+    }
+
+    void reset() noexcept
+    {
+        std::lock_guard<Thread> lock(m_Lock);
+        m_pFreeList = nullptr;
+        m_Arena.reset();
+    }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* m_pNext;
+    };
+
+    arena_type m_Arena;
+    FreeBlock* m_pFreeList = nullptr;
+    Thread m_Lock;
+};
+
+// N bytes on the heap, throws when full
+template <std::size_t N>
+using HeapArena = BasicArena<HeapStorage<N> >;
+
+// N bytes on the stack, throws when full
+template <std::size_t N>
+using StackArena = BasicArena<StackStorage<N> >;
+
+// N bytes on the heap shared by threads
+template <std::size_t N, class Thread = SpinLocked>
+using SharedHeapArena = BasicArena<HeapStorage<N>, ThrowOnExhaust, Thread>;
+
+// blocks of BlockSize bytes from N bytes on the heap
+template <std::size_t N, std::size_t BlockSize = 64>
+using HeapPool = BasicPool<HeapStorage<N>, BlockSize>;
+
+// local allocator of T, maximum N bytes, default to 1KB
+// Arena is any of the arenas above, or a type with the same allocate/deallocate/try_expand interface
+template <class T, std::size_t N = 1024, class Arena = StackArena<N> >
+class LocalAllocator
+{
+public:
+    using value_type = T;
+    static auto constexpr element_size = sizeof(T);
+    using arena_type = Arena;
+
+    static_assert(alignof(T) <= Arena::alignment, "alignment of T is larger than the alignment of the arena");
+
+private:
+    using data_type = typename arena_type::value_type;
+
+    // held by pointer so the allocator is copy assignable, as nested containers require
+    arena_type* m_pArena;
+
+public:
+    LocalAllocator(const LocalAllocator&) = default;
+    LocalAllocator& operator=(const LocalAllocator&) = default;
+
+    LocalAllocator(arena_type& a) noexcept : m_pArena(&a) {}
+    template <class U>
+    LocalAllocator(const LocalAllocator<U, N, Arena>& a) noexcept : m_pArena(a.m_pArena) {}
+
+    template <typename U> struct rebind { typedef LocalAllocator<U, N, Arena> other; };
+
+    arena_type& arena() const noexcept { return *m_pArena; }
+
+    value_type* allocate(std::size_t n) { return reinterpret_cast<value_type*>(m_pArena->allocate(n * element_size)); }
+
+    void deallocate(value_type* p, std::size_t n) { m_pArena->deallocate(reinterpret_cast<data_type*>(p), n * element_size); }
+
+    // Grow an allocation of oldN elements to newN in place, SmallVector uses this to grow without copying
+    bool try_expand(value_type* p, std::size_t oldN, std::size_t newN)
+    {
+        return m_pArena->try_expand(reinterpret_cast<data_type*>(p), oldN * element_size, newN * element_size);
+    }
+
+    // allocators are equal when they share an arena, allocators of different arena types never compare
+    template <class T1, class T2, std::size_t M, class A>
+    friend bool operator==(const LocalAllocator<T1, M, A>& x, const LocalAllocator<T2, M, A>& y) noexcept;
+
+    template<class U, std::size_t M, class A> friend class LocalAllocator;
+};
+
+template <class T1, class T2, std::size_t N, class Arena>
+bool operator==(const LocalAllocator<T1, N, Arena>& x, const LocalAllocator<T2, N, Arena>& y) noexcept
+{
+    return x.m_pArena == y.m_pArena;
+}
+
+template <class T1, class T2, std::size_t N, class Arena>
+bool operator!=(const LocalAllocator<T1, N, Arena>& x, const LocalAllocator<T2, N, Arena>& y) noexcept
+{
+    return !(x == y);
+}
+
+// Rewinds an arena to its position at construction when the scope exits
+// Declare the scope before the containers that use the arena, so they are destroyed first
+template <class Arena>
+class ArenaScope
+{
+public:
+    explicit ArenaScope(Arena& a) noexcept
+        : m_Arena(a)
+        , m_Marker(a.mark())
+    {
+    }
+    ~ArenaScope() { m_Arena.rewind(m_Marker); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena& m_Arena;
+    typename Arena::marker m_Marker;
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+
+// Set ARENA_STATS to 1 to record allocation statistics in the arena classes
+// When 0 (the default) the recorder is an empty base class and every hook compiles away
+#ifndef ARENA_STATS
+#define ARENA_STATS 0
+#endif
+
+// Allocation statistics for a single arena
+struct ArenaStats
+{
+    static constexpr std::size_t histogram_size = 16;
+
+    std::size_t allocations = 0;         // successful allocations, including heap fallbacks
+    std::size_t deallocations = 0;       // calls to deallocate
+    std::size_t bytes_allocated = 0;     // total bytes requested over the lifetime of the arena
+    std::size_t high_water_mark = 0;     // largest number of arena bytes in use at any time
+    std::size_t heap_fallbacks = 0;      // allocations satisfied by ::operator new because the arena was full
+    std::size_t heap_fallback_bytes = 0; // bytes satisfied by ::operator new
+    std::size_t failed_allocations = 0;  // allocations that threw std::bad_alloc
+    std::size_t expansions = 0;          // allocations grown in place by try_expand
+
+    // allocation size histogram, bucket i counts sizes in [2^i, 2^(i+1)), the last bucket counts everything larger
+    std::size_t histogram[histogram_size] = {};
+
+    static std::size_t bucket(std::size_t n) noexcept
+    {
+        std::size_t i = 0;
+        for (; n > 1 && i < histogram_size - 1; n >>= 1)
+        {
+            ++i;
+        }
+        return i;
+    }
+};
+
+#if ARENA_STATS
+
+// Records allocation events, arenas inherit from this to keep the hooks out of the arena logic
+class ArenaStatsRecorder
+{
+public:
+    const ArenaStats& stats() const noexcept { return m_Stats; }
+    void reset_stats() noexcept { m_Stats = ArenaStats{}; }
+
+protected:
+    // n bytes were taken from the arena, leaving used bytes in use
+    void on_allocate(std::size_t n, std::size_t used) noexcept
+    {
+        ++m_Stats.allocations;
+        m_Stats.bytes_allocated += n;
+        ++m_Stats.histogram[ArenaStats::bucket(n)];
+        if (used > m_Stats.high_water_mark)
+        {
+            m_Stats.high_water_mark = used;
+        }
+    }
+
+    void on_deallocate(std::size_t) noexcept { ++m_Stats.deallocations; }
+
+    // n bytes did not fit in the arena and were allocated from the heap
+    void on_heap_fallback(std::size_t n) noexcept
+    {
+        ++m_Stats.allocations;
+        ++m_Stats.heap_fallbacks;
+        m_Stats.bytes_allocated += n;
+        m_Stats.heap_fallback_bytes += n;
+        ++m_Stats.histogram[ArenaStats::bucket(n)];
+    }
+
+    void on_failure(std::size_t) noexcept { ++m_Stats.failed_allocations; }
+
+    // the last allocation grew in place by n bytes, leaving used bytes in use
+    void on_expand(std::size_t n, std::size_t used) noexcept
+    {
+        ++m_Stats.expansions;
+        m_Stats.bytes_allocated += n;
+        if (used > m_Stats.high_water_mark)
+        {
+            m_Stats.high_water_mark = used;
+        }
+    }
+
+private:
+    ArenaStats m_Stats;
+};
+
+#else
+
+class ArenaStatsRecorder
+{
+public:
+    const ArenaStats& stats() const noexcept
+    {
+        static const ArenaStats empty;
+        return empty;
+    }
+    void reset_stats() noexcept {}
+
+protected:
+    void on_allocate(std::size_t, std::size_t) noexcept {}
+    void on_deallocate(std::size_t) noexcept {}
+    void on_heap_fallback(std::size_t) noexcept {}
+    void on_failure(std::size_t) noexcept {}
+    void on_expand(std::size_t, std::size_t) noexcept {}
+};
+
+#endif
+
+// Write the statistics of an arena to the trace output
+template <typename Arena>
+void TraceArenaStats(const char* name, const Arena& a)
+{
+    const ArenaStats& s = a.stats();
+    Mercury::Trace("arena %s: size %zu used %zu high water %zu\n", name, a.size(), a.used(), s.high_water_mark);
+    Mercury::Trace("  allocations %zu deallocations %zu bytes %zu\n", s.allocations, s.deallocations, s.bytes_allocated);
+    Mercury::Trace("  heap fallbacks %zu (%zu bytes) failed %zu expansions %zu\n", s.heap_fallbacks, s.heap_fallback_bytes, s.failed_allocations,
+                   s.expansions);
+    for (std::size_t i = 0; i < ArenaStats::histogram_size; ++i)
+    {
+        if (s.histogram[i] && i + 1 < ArenaStats::histogram_size)
+        {
+            Mercury::Trace("  [%zu, %zu) %zu\n", std::size_t(1) << i, std::size_t(2) << i, s.histogram[i]);
+        }
+        else if (s.histogram[i])
+        {
+            Mercury::Trace("  [%zu, ...) %zu\n", std::size_t(1) << i, s.histogram[i]);
+        }
+    }
+}
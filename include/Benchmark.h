@@ -0,0 +1,184 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// clang-format off
+namespace Benchmark
+{
+// clang-format on
+
+// Prevent the compiler from discarding a value computed by a benchmark
+template <typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(_MSC_VER)
+    static volatile const void* sink;
+    sink = &value;
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+class Timer
+{
+public:
+    Timer() { reset(); }
+
+    void reset() { m_Start = std::chrono::steady_clock::now(); }
+
+    double elapsed_ns() const { return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - m_Start).count(); }
+
+private:
+    std::chrono::steady_clock::time_point m_Start;
+};
+
+// Number of page faults taken by the process so far
+inline std::uint64_t PageFaults()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc{};
+    ::GetProcessMemoryInfo(::GetCurrentProcess(), &pmc, sizeof(pmc));
+    return pmc.PageFaultCount;
+#else
+    rusage usage{};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return static_cast<std::uint64_t>(usage.ru_minflt + usage.ru_majflt);
+#endif
+}
+
+// Counts data TLB read misses of the calling thread, on Linux only and when perf events are permitted
+class TlbMissCounter
+{
+public:
+    TlbMissCounter()
+    {
+#if defined(__linux__)
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = static_cast<int>(::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~TlbMissCounter()
+    {
+#if defined(__linux__)
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+        }
+#endif
+    }
+    TlbMissCounter(const TlbMissCounter&) = delete;
+    TlbMissCounter& operator=(const TlbMissCounter&) = delete;
+
+    bool available() const { return m_fd >= 0; }
+
+    void start()
+    {
+#if defined(__linux__)
+        if (m_fd >= 0)
+        {
+            ::ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Returns the misses since start(), or -1 when the counter is unavailable
+    long long stop()
+    {
+        long long count = -1;
+#if defined(__linux__)
+        if (m_fd >= 0)
+        {
+            ::ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (::read(m_fd, &count, sizeof(count)) != sizeof(count))
+            {
+                count = -1;
+            }
+        }
+#endif
+        return count;
+    }
+
+private:
+    int m_fd = -1;
+};
+
+struct Result
+{
+    const char* suite = "";
+    const char* name = "";
+    std::size_t size = 0;        // problem size, elements or bytes depending on the benchmark
+    std::size_t operations = 1;  // operations timed, used to report ns per operation
+    double ns = 0.0;
+    std::uint64_t page_faults = 0;
+    long long tlb_misses = -1;   // -1 when not measured
+    std::size_t bytes = 0;       // memory consumed, 0 when not measured
+};
+
+// Write a result as one JSON object per line, so runs can be collected and compared by scripts
+inline void Report(const Result& r)
+{
+    std::printf("{\"suite\":\"%s\",\"name\":\"%s\",\"size\":%zu,\"ns\":%.0f,\"ns_per_op\":%.3f,\"page_faults\":%llu,\"tlb_misses\":%lld,\"bytes\":%zu}\n",
+                r.suite, r.name, r.size, r.ns, r.operations ? r.ns / r.operations : 0.0, static_cast<unsigned long long>(r.page_faults),
+                r.tlb_misses, r.bytes);
+}
+
+// Time a callable, repeating it and keeping the fastest run, and record page faults and TLB misses of that run
+template <typename Fn>
+Result Measure(const char* suite, const char* name, std::size_t size, std::size_t operations, Fn&& fn, int repeats = 3)
+{
+    Result best;
+    best.suite = suite;
+    best.name = name;
+    best.size = size;
+    best.operations = operations;
+
+    TlbMissCounter tlb;
+    for (int i = 0; i < repeats; ++i)
+    {
+        const auto faults = PageFaults();
+        tlb.start();
+        Timer timer;
+        fn();
+        const double ns = timer.elapsed_ns();
+        const long long misses = tlb.stop();
+
+        if (i == 0 || ns < best.ns)
+        {
+            best.ns = ns;
+            best.page_faults = PageFaults() - faults;
+            best.tlb_misses = misses;
+        }
+    }
+    return best;
+}
+
+}  // namespace Benchmark
@@ -0,0 +1,274 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "IteratorTraits.h"
+#include "Range.h"
+#include "Sentinel.h"
+
+// range | chunk(n) yields the elements of range as spans of up to n elements, so a kernel can work on a
+// block at a time instead of being driven one element at a time
+// Over a contiguous range (vector, string, array) every span points into the range itself and nothing is
+// copied. Any other range is read into a batch buffer owned by the iterator, that span is valid until the
+// iterator is incremented and the buffer is reused from one batch to the next
+
+// clang-format off
+namespace Range
+{
+// clang-format on
+
+// View of size contiguous elements
+template <typename T>
+class span final
+{
+public:
+    using value_type = typename std::remove_cv<T>::type;
+    using iterator = T*;
+    using const_iterator = T*;
+
+    span() = default;
+
+    span(T* data, std::size_t size)
+        : m_pData(data)
+        , m_nSize(size)
+    {
+    }
+
+    T* data() const { return m_pData; }
+    std::size_t size() const { return m_nSize; }
+    bool empty() const { return m_nSize == 0; }
+
+    T& operator[](std::size_t i) const { return m_pData[i]; }
+
+    T* begin() const { return m_pData; }
+    T* end() const { return m_pData + m_nSize; }
+
+private:
+    T* m_pData = nullptr;
+    std::size_t m_nSize = 0;
+};
+
+namespace detail {
+
+// A range is contiguous when it has data() and size() and random-access iterators
+template <typename Rng, typename = void>
+struct is_contiguous_range : std::false_type
+{
+};
+
+template <typename Rng>
+struct is_contiguous_range<Rng, std::void_t<decltype(std::declval<const Rng&>().data()), decltype(std::declval<const Rng&>().size())> >
+    : is_random_access_iterator<decltype(std::declval<const Rng&>().begin())>
+{
+};
+
+}  // namespace detail
+
+// Chunks of a contiguous range, the last chunk holds what is left
+template <typename T>
+class contiguous_chunk_iterator final
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = span<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = value_type;
+
+    explicit contiguous_chunk_iterator(T* first, T* last, std::size_t n)
+        : m_pCurrent(first)
+        , m_pLast(last)
+        , m_nSize(n)
+    {
+    }
+
+    // Iterator requires CopyConstructible, CopyAssignable, Destructible
+    ~contiguous_chunk_iterator() = default;
+    contiguous_chunk_iterator(const contiguous_chunk_iterator&) = default;
+    contiguous_chunk_iterator& operator=(const contiguous_chunk_iterator&) = default;
+
+    contiguous_chunk_iterator& operator++()
+    {
+        m_pCurrent += chunk_size();
+        return *this;
+    }
+
+    // Required by InputIterator
+    value_type operator*() const { return value_type(m_pCurrent, chunk_size()); }
+
+    bool operator==(const contiguous_chunk_iterator& rhs) const { return m_pCurrent == rhs.m_pCurrent; }
+    bool operator!=(const contiguous_chunk_iterator& rhs) const { return m_pCurrent != rhs.m_pCurrent; }
+
+    // Required by ForwardIterator
+    contiguous_chunk_iterator() = default;
+
+    contiguous_chunk_iterator operator++(int)
+    {
+        contiguous_chunk_iterator temp(*this);
+        ++(*this);
+        return temp;
+    }
+
+private:
+    std::size_t chunk_size() const
+    {
+        const std::size_t left = static_cast<std::size_t>(m_pLast - m_pCurrent);
+        return left < m_nSize ? left : m_nSize;
+    }
+
+    T* m_pCurrent = nullptr;
+    T* m_pLast = nullptr;
+    std::size_t m_nSize = 0;
+};
+
+// Batches of up to n elements read from any range into a buffer owned by the iterator
+// The range ends at a batch_sentinel, reached once a batch comes back empty. The first batch is read on
+// first use rather than on construction, so building the view reads nothing from the base and copies of the
+// view or of an unread iterator carry an empty buffer
+template <typename BaseIterator, typename BaseSentinel>
+class batch_iterator final
+{
+    static_assert(is_input_iterator<BaseIterator>::value, "batch_iterator requires input iterator");
+
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = span<const typename std::iterator_traits<BaseIterator>::value_type>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = value_type;
+
+    explicit batch_iterator(BaseIterator first, BaseSentinel last, std::size_t n)
+        : m_iterator(first)
+        , m_last(last)
+        , m_nSize(n)
+    {
+    }
+
+    // Iterator requires CopyConstructible, CopyAssignable, Destructible
+    ~batch_iterator() = default;
+    batch_iterator(const batch_iterator&) = default;
+    batch_iterator& operator=(const batch_iterator&) = default;
+
+    batch_iterator& operator++()
+    {
+        load();
+        fill();
+        return *this;
+    }
+
+    // Required by InputIterator
+    value_type operator*() const
+    {
+        load();
+        return value_type(m_Batch.data(), m_Batch.size());
+    }
+
+    batch_iterator() = default;
+
+    batch_iterator operator++(int)
+    {
+        batch_iterator temp(*this);
+        ++(*this);
+        return temp;
+    }
+
+    bool done() const
+    {
+        load();
+        return m_Batch.empty();
+    }
+
+private:
+    // read the current batch if it has not been read yet
+    void load() const
+    {
+        if (!m_bLoaded)
+        {
+            m_Batch.reserve(m_nSize);
+            fill();
+        }
+    }
+
+    void fill() const
+    {
+        m_bLoaded = true;
+        m_Batch.clear();
+        for (; m_Batch.size() < m_nSize && m_iterator != m_last; ++m_iterator)
+        {
+            m_Batch.push_back(*m_iterator);
+        }
+    }
+
+    // the position in the base and the batch are read on first use, from the const operations too
+    mutable BaseIterator m_iterator{};
+    BaseSentinel m_last{};
+    std::size_t m_nSize = 0;
+    mutable std::vector<typename std::iterator_traits<BaseIterator>::value_type> m_Batch;
+    mutable bool m_bLoaded = false;
+};
+
+struct batch_sentinel
+{
+};
+
+template <typename BaseIterator, typename BaseSentinel>
+bool operator==(const batch_iterator<BaseIterator, BaseSentinel>& it, batch_sentinel)
+{
+    return it.done();
+}
+
+template <typename BaseIterator, typename BaseSentinel>
+bool operator!=(const batch_iterator<BaseIterator, BaseSentinel>& it, batch_sentinel)
+{
+    return !it.done();
+}
+
+namespace detail {
+
+template <typename Rng>
+auto make_chunk_range(const Rng& range, std::size_t n, std::true_type)
+    -> IteratorRange<contiguous_chunk_iterator<typename std::remove_pointer<decltype(range.data())>::type> >
+{
+    using T = typename std::remove_pointer<decltype(range.data())>::type;
+    T* first = range.data();
+    T* last = first + range.size();
+    return make_range(contiguous_chunk_iterator<T>(first, last, n), contiguous_chunk_iterator<T>(last, last, n));
+}
+
+template <typename Rng>
+auto make_chunk_range(const Rng& range, std::size_t n, std::false_type)
+    -> SentinelRange<batch_iterator<decltype(range.begin()), decltype(range.end())>, batch_sentinel>
+{
+    using iterator = batch_iterator<decltype(range.begin()), decltype(range.end())>;
+    return make_sentinel_range(iterator(range.begin(), range.end(), n), batch_sentinel());
+}
+
+}  // namespace detail
+
+// clang-format off
+class chunk_holder : public detail::holder<size_t>
+{
+public:
+    explicit chunk_holder(size_t n) : detail::holder<size_t>(n) {}
+};
+// clang-format on
+
+// Construct chunk adaptor, n must be at least one
+inline chunk_holder chunk(size_t n)
+{
+    assert(n != 0 && "chunk size must be at least one");
+    return chunk_holder(n);
+}
+
+// Construct view of the range in chunks of up to n elements
+template <typename Rng>
+auto operator|(const Rng& range, chunk_holder chunker)
+    -> decltype(detail::make_chunk_range(range, chunker.get(), detail::is_contiguous_range<Rng>()))
+{
+    return detail::make_chunk_range(range, chunker.get(), detail::is_contiguous_range<Rng>());
+}
+
+}  // namespace Range
@@ -11,9 +11,11 @@
 #include <deque>
 #include <iostream>
 #include <string>
+#include "AllocationCounter.h"
 #include "CircularQueue.h"
 #include "eastl/string.h"
 #include <list>
+#include <numeric>
 
 namespace CircularQueueTest {
 
@@ -885,6 +887,37 @@ void DoNestedQueueTest()
     }
 }
 
+// Once constructed, a queue of trivial elements must not touch the heap
+static void DoAllocationTests()
+{
+    CircularQueue<int> q(16);
+    CircularQueue<int> other(16);
+
+    AllocationCounter::ExpectNoAllocations guard("CircularQueue<int>");
+    for (int i = 0; i < 100; ++i)
+    {
+        q.push(i);
+        if (i % 3 == 0)
+        {
+            q.pop();
+        }
+    }
+    const auto size = q.size();
+    assert(size == 15);
+
+    int sum = 0;
+    for (auto i : q)
+    {
+        sum += i;
+    }
+    assert(sum == std::accumulate(q.begin(), q.end(), 0));
+
+    q.swap(other);
+    CircularQueue<int> moved(std::move(other));
+    q = std::move(moved);
+    assert(q.size() == size);
+}
+
 static eastl::wstring wsEASTLmessage = L"TestMessage";
 static std::wstring wsSTDmessage = L"TestMessage";
 
@@ -984,6 +1017,8 @@ void RunCircularQueueTest()
     DoEASTLSequenceContainerTests<eastl::list>();
 
     DoNestedQueueTest<int>();
+
+    DoAllocationTests();
 }
 
 }  // namespace CircularQueueTest
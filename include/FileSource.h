@@ -0,0 +1,484 @@
+#pragma once
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Chunk.h"
+#include "Range.h"
+#include "Sentinel.h"
+
+#if defined(_WIN32)
+// keep the min and max macros out of std::min( and numeric_limits<>::max() in the headers that follow
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Files as source ranges of adaptor pipelines, lines(file) | filter(p) | transform(f)
+// MappedFile maps the whole file read-only and hints the kernel that it is read front to back, which reads
+// ahead and lets the pages already read be dropped, so a file larger than RAM streams through the page
+// cache. Its lines are string_views into the mapping and its records<T> are T* into it: the ranges stay
+// valid while the MappedFile lives and reading them allocates nothing
+// FileReader reads through one buffer of fixed size with plain reads, for files that cannot be mapped
+// (pipes, network shares) or when the address space is short. Its ranges are input ranges and each line or
+// record is a view into the buffer that is valid until the iterator is incremented
+// Both throw std::system_error when the file cannot be opened
+
+// clang-format off
+namespace Range
+{
+// clang-format on
+
+// Read-only mapping of a whole file
+class MappedFile final
+{
+public:
+    explicit MappedFile(const char* path)
+    {
+#if defined(_WIN32)
+        HANDLE file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            throw std::system_error(static_cast<int>(::GetLastError()), std::system_category(), path);
+        }
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(file, &size))
+        {
+            const DWORD error = ::GetLastError();
+            ::CloseHandle(file);
+            throw std::system_error(static_cast<int>(error), std::system_category(), path);
+        }
+        m_nSize = static_cast<std::size_t>(size.QuadPart);
+        if (m_nSize != 0)
+        {
+            HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr)
+            {
+                m_pData = static_cast<const char*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                ::CloseHandle(mapping);
+            }
+            if (m_pData == nullptr)
+            {
+                const DWORD error = ::GetLastError();
+                ::CloseHandle(file);
+                throw std::system_error(static_cast<int>(error), std::system_category(), path);
+            }
+        }
+        ::CloseHandle(file);
+#else
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), path);
+        }
+        struct stat status;
+        if (::fstat(fd, &status) != 0)
+        {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), path);
+        }
+        m_nSize = static_cast<std::size_t>(status.st_size);
+        if (m_nSize != 0)
+        {
+            void* p = ::mmap(nullptr, m_nSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), path);
+            }
+            ::madvise(p, m_nSize, MADV_SEQUENTIAL);
+            m_pData = static_cast<const char*>(p);
+        }
+        // the mapping keeps the file open
+        ::close(fd);
+#endif
+    }
+
+    ~MappedFile() { unmap(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : m_pData(std::exchange(other.m_pData, nullptr))
+        , m_nSize(std::exchange(other.m_nSize, 0))
+    {
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            m_pData = std::exchange(other.m_pData, nullptr);
+            m_nSize = std::exchange(other.m_nSize, 0);
+        }
+        return *this;
+    }
+
+    const char* data() const noexcept { return m_pData; }
+    std::size_t size() const noexcept { return m_nSize; }
+
+private:
+    void unmap() noexcept
+    {
+        if (m_pData != nullptr)
+        {
+#if defined(_WIN32)
+            ::UnmapViewOfFile(m_pData);
+#else
+            ::munmap(const_cast<char*>(m_pData), m_nSize);
+#endif
+        }
+    }
+
+    const char* m_pData = nullptr;
+    std::size_t m_nSize = 0;
+};
+
+// Reads a file front to back through a buffer of fixed size
+// The buffer only grows when a single line is longer than it
+class FileReader final
+{
+public:
+    static constexpr std::size_t default_buffer_size = 1024 * 1024;
+
+    explicit FileReader(const char* path, std::size_t bufferSize = default_buffer_size)
+        : m_Buffer(bufferSize)
+    {
+        assert(bufferSize != 0 && "buffer size must be at least one");
+#if defined(_WIN32)
+        m_hFile = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_hFile == INVALID_HANDLE_VALUE)
+        {
+            throw std::system_error(static_cast<int>(::GetLastError()), std::system_category(), path);
+        }
+#else
+        m_nFile = ::open(path, O_RDONLY);
+        if (m_nFile < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), path);
+        }
+        ::posix_fadvise(m_nFile, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    }
+
+    ~FileReader()
+    {
+#if defined(_WIN32)
+        ::CloseHandle(m_hFile);
+#else
+        ::close(m_nFile);
+#endif
+    }
+
+    FileReader(const FileReader&) = delete;
+    FileReader& operator=(const FileReader&) = delete;
+
+    // Next line without its line break, false at the end of the file
+    bool read_line(std::string_view& line)
+    {
+        std::size_t searched = m_nBegin;
+        for (;;)
+        {
+            const void* found = std::memchr(m_Buffer.data() + searched, '\n', m_nEnd - searched);
+            if (found != nullptr)
+            {
+                const std::size_t end = static_cast<std::size_t>(static_cast<const char*>(found) - m_Buffer.data());
+                line = trim(m_Buffer.data() + m_nBegin, end - m_nBegin);
+                m_nBegin = end + 1;
+                return true;
+            }
+            searched = m_nEnd - m_nBegin;
+            if (!refill())
+            {
+                // the last line has no line break
+                if (m_nBegin == m_nEnd)
+                {
+                    return false;
+                }
+                line = trim(m_Buffer.data() + m_nBegin, m_nEnd - m_nBegin);
+                m_nBegin = m_nEnd;
+                return true;
+            }
+            searched += m_nBegin;
+        }
+    }
+
+    // Next size bytes, false at the end of the file, a partial record at the end is dropped
+    bool read_record(std::size_t size, span<const char>& record)
+    {
+        while (m_nEnd - m_nBegin < size)
+        {
+            if (!refill())
+            {
+                return false;
+            }
+        }
+        record = span<const char>(m_Buffer.data() + m_nBegin, size);
+        m_nBegin += size;
+        return true;
+    }
+
+private:
+    static std::string_view trim(const char* first, std::size_t size)
+    {
+        return std::string_view(first, size != 0 && first[size - 1] == '\r' ? size - 1 : size);
+    }
+
+    // Move the unread bytes to the front of the buffer, growing it when they fill it, and read after them
+    // false once the file has no more bytes
+    bool refill()
+    {
+        if (m_bEof)
+        {
+            return false;
+        }
+        const std::size_t left = m_nEnd - m_nBegin;
+        std::memmove(m_Buffer.data(), m_Buffer.data() + m_nBegin, left);
+        m_nBegin = 0;
+        m_nEnd = left;
+        if (m_nEnd == m_Buffer.size())
+        {
+            m_Buffer.resize(m_Buffer.size() * 2);
+        }
+
+        const std::size_t read = read_some(m_Buffer.data() + m_nEnd, m_Buffer.size() - m_nEnd);
+        m_nEnd += read;
+        m_bEof = read == 0;
+        return !m_bEof;
+    }
+
+    std::size_t read_some(char* buffer, std::size_t size)
+    {
+#if defined(_WIN32)
+        DWORD read = 0;
+        const DWORD request = size < 0x40000000 ? static_cast<DWORD>(size) : 0x40000000;
+        if (!::ReadFile(m_hFile, buffer, request, &read, nullptr))
+        {
+            throw std::system_error(static_cast<int>(::GetLastError()), std::system_category(), "FileReader::read");
+        }
+        return read;
+#else
+        for (;;)
+        {
+            const ssize_t read = ::read(m_nFile, buffer, size);
+            if (read >= 0)
+            {
+                return static_cast<std::size_t>(read);
+            }
+            if (errno != EINTR)
+            {
+                throw std::system_error(errno, std::generic_category(), "FileReader::read");
+            }
+        }
+#endif
+    }
+
+#if defined(_WIN32)
+    HANDLE m_hFile = INVALID_HANDLE_VALUE;
+#else
+    int m_nFile = -1;
+#endif
+    std::vector<char> m_Buffer;
+    std::size_t m_nBegin = 0;
+    std::size_t m_nEnd = 0;
+    bool m_bEof = false;
+};
+
+// Lines of a mapped file, the line break and a carriage return before it are not part of the line
+class mapped_line_iterator final
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = value_type;
+
+    explicit mapped_line_iterator(const char* first, const char* last)
+        : m_pCurrent(first)
+        , m_pLast(last)
+    {
+        find_end();
+    }
+
+    // Iterator requires CopyConstructible, CopyAssignable, Destructible
+    ~mapped_line_iterator() = default;
+    mapped_line_iterator(const mapped_line_iterator&) = default;
+    mapped_line_iterator& operator=(const mapped_line_iterator&) = default;
+
+    mapped_line_iterator& operator++()
+    {
+        m_pCurrent = m_pLineEnd == m_pLast ? m_pLast : m_pLineEnd + 1;
+        find_end();
+        return *this;
+    }
+
+    // Required by InputIterator
+    reference operator*() const
+    {
+        const std::size_t size = static_cast<std::size_t>(m_pLineEnd - m_pCurrent);
+        return std::string_view(m_pCurrent, size != 0 && m_pLineEnd[-1] == '\r' ? size - 1 : size);
+    }
+
+    bool operator==(const mapped_line_iterator& rhs) const { return m_pCurrent == rhs.m_pCurrent; }
+    bool operator!=(const mapped_line_iterator& rhs) const { return m_pCurrent != rhs.m_pCurrent; }
+
+    // Required by ForwardIterator
+    mapped_line_iterator() = default;
+
+    mapped_line_iterator operator++(int)
+    {
+        mapped_line_iterator temp(*this);
+        ++(*this);
+        return temp;
+    }
+
+private:
+    void find_end()
+    {
+        const void* found = m_pCurrent == m_pLast ? nullptr : std::memchr(m_pCurrent, '\n', static_cast<std::size_t>(m_pLast - m_pCurrent));
+        m_pLineEnd = found != nullptr ? static_cast<const char*>(found) : m_pLast;
+    }
+
+    const char* m_pCurrent = nullptr;
+    const char* m_pLineEnd = nullptr;
+    const char* m_pLast = nullptr;
+};
+
+// Lines or records read through a FileReader, the view is valid until the iterator is incremented
+// Value is std::string_view for lines and span<const char> for records
+template <typename Value>
+class reader_iterator final
+{
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = value_type;
+
+    // record size 0 reads lines
+    explicit reader_iterator(FileReader& reader, std::size_t recordSize)
+        : m_pReader(&reader)
+        , m_nRecordSize(recordSize)
+    {
+        read();
+    }
+
+    // Iterator requires CopyConstructible, CopyAssignable, Destructible
+    ~reader_iterator() = default;
+    reader_iterator(const reader_iterator&) = default;
+    reader_iterator& operator=(const reader_iterator&) = default;
+
+    reader_iterator& operator++()
+    {
+        read();
+        return *this;
+    }
+
+    // Required by InputIterator
+    reference operator*() const { return m_Value; }
+
+    reader_iterator() = default;
+
+    reader_iterator operator++(int)
+    {
+        reader_iterator temp(*this);
+        ++(*this);
+        return temp;
+    }
+
+    bool done() const { return m_bDone; }
+
+private:
+    void read()
+    {
+        if constexpr (std::is_same<Value, std::string_view>::value)
+        {
+            m_bDone = !m_pReader->read_line(m_Value);
+        }
+        else
+        {
+            m_bDone = !m_pReader->read_record(m_nRecordSize, m_Value);
+        }
+    }
+
+    FileReader* m_pReader = nullptr;
+    std::size_t m_nRecordSize = 0;
+    Value m_Value{};
+    bool m_bDone = true;
+};
+
+// End of the ranges of a FileReader, reached once a read comes back empty
+struct reader_sentinel
+{
+};
+
+template <typename Value>
+bool operator==(const reader_iterator<Value>& it, reader_sentinel)
+{
+    return it.done();
+}
+
+template <typename Value>
+bool operator!=(const reader_iterator<Value>& it, reader_sentinel)
+{
+    return !it.done();
+}
+
+// Construct view of the lines of the mapped file
+inline IteratorRange<mapped_line_iterator> lines(const MappedFile& file)
+{
+    const char* last = file.data() + file.size();
+    return make_range(mapped_line_iterator(file.data(), last), mapped_line_iterator(last, last));
+}
+
+// Construct view of the file as an array of Record, a partial record at the end is not part of it
+// Record must be trivially copyable and stored in the file in the layout of this build
+template <typename Record>
+IteratorRange<const Record*> records(const MappedFile& file)
+{
+    static_assert(std::is_trivially_copyable<Record>::value, "records requires a trivially copyable record");
+    const Record* first = reinterpret_cast<const Record*>(file.data());
+    return make_range(first, first + file.size() / sizeof(Record));
+}
+
+// Construct view of the file in records of size bytes, a partial record at the end is not part of it
+inline auto records(const MappedFile& file, std::size_t size) -> decltype(span<const char>() | chunk(size))
+{
+    return span<const char>(file.data(), file.size() / size * size) | chunk(size);
+}
+
+// Construct input view of the lines read through the reader
+inline SentinelRange<reader_iterator<std::string_view>, reader_sentinel> lines(FileReader& reader)
+{
+    return make_sentinel_range(reader_iterator<std::string_view>(reader, 0), reader_sentinel());
+}
+
+// Construct input view of the records of size bytes read through the reader
+inline SentinelRange<reader_iterator<span<const char> >, reader_sentinel> records(FileReader& reader, std::size_t size)
+{
+    assert(size != 0 && "record size must be at least one");
+    return make_sentinel_range(reader_iterator<span<const char> >(reader, size), reader_sentinel());
+}
+
+}  // namespace Range
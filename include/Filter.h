@@ -1,12 +1,14 @@
 #pragma once
 #include "IteratorTraits.h"
 #include "Range.h"
+#include "Sentinel.h"
 #include "View.h"
 
 // clang-format off
 namespace Range
 {
-template <typename BaseIterator, typename UnaryPredicate>
+// BaseSentinel is the type of the base range's end, the base iterator unless the base is a SentinelRange
+template <typename BaseIterator, typename UnaryPredicate, typename BaseSentinel = BaseIterator>
 class filter_iterator final
 {
     static_assert(is_input_iterator<BaseIterator>::value, "filter_iterator requires input iterator");
@@ -14,7 +16,7 @@ class filter_iterator final
     UnaryPredicate m_pred{};
     BaseIterator m_iterator{};
     BaseIterator m_first{};
-    BaseIterator m_last{};
+    BaseSentinel m_last{};
 
 public:
     using iterator_category =
@@ -28,7 +30,7 @@ public:
     // this is to accomodate applying a filter to a transform, whose operator* returns by value
     using DereferenceType = typename std::conditional<std::is_reference<decltype(*m_iterator)>::value, reference, value_type>::type;
 
-    explicit filter_iterator(BaseIterator first, BaseIterator last, UnaryPredicate pred)
+    explicit filter_iterator(BaseIterator first, BaseSentinel last, UnaryPredicate pred)
         : m_pred(pred)
         , m_iterator(first)
         , m_first(first)
@@ -59,8 +61,8 @@ public:
     // Required by InputIterator
     DereferenceType operator*() { return *m_iterator; }
 
-    bool operator==(const filter_iterator& rhs) { return m_iterator == rhs.m_iterator; }
-    bool operator!=(const filter_iterator& rhs) { return m_iterator != rhs.m_iterator; }
+    bool operator==(const filter_iterator& rhs) const { return m_iterator == rhs.m_iterator; }
+    bool operator!=(const filter_iterator& rhs) const { return m_iterator != rhs.m_iterator; }
 
     // Required by ForwardIterator
     filter_iterator() = default;
@@ -87,6 +89,10 @@ public:
         return temp;
     }
 
+    // Underlying iterator and predicate, used by Fusion.h to run a pipeline over the innermost iterator
+    const BaseIterator& base() const { return m_iterator; }
+    const UnaryPredicate& predicate() const { return m_pred; }
+
 private:
     void increment_predicate()
     {
@@ -103,11 +109,11 @@ private:
     }
 };
 
-template <typename BaseIterator, typename UnaryPredicate>
-filter_iterator<BaseIterator, UnaryPredicate> make_filter_iterator(BaseIterator first, BaseIterator last, UnaryPredicate pred)
+template <typename BaseIterator, typename UnaryPredicate, typename BaseSentinel>
+filter_iterator<BaseIterator, UnaryPredicate, BaseSentinel> make_filter_iterator(BaseIterator first, BaseSentinel last, UnaryPredicate pred)
 {
-    static_assert(is_iterator<filter_iterator<BaseIterator, UnaryPredicate> >::value, "is_iterator failed");
-    return filter_iterator<BaseIterator, UnaryPredicate>(first, last, pred);
+    static_assert(is_iterator<filter_iterator<BaseIterator, UnaryPredicate, BaseSentinel> >::value, "is_iterator failed");
+    return filter_iterator<BaseIterator, UnaryPredicate, BaseSentinel>(first, last, pred);
 }
 
 // clang-format off
@@ -144,4 +150,12 @@ auto operator|(const IteratorRange<Iterator>& range, unary_predicate<UnaryPredic
                       make_filter_iterator(range.end(), range.end(), filter.get()));
 }
 
+// Construct view by applying filter adaptor to the sentinel range
+template <typename Iterator, typename Sentinel, typename UnaryPredicate>
+auto operator|(const SentinelRange<Iterator, Sentinel>& range, unary_predicate<UnaryPredicate> filter)
+    -> SentinelRange<filter_iterator<Iterator, UnaryPredicate, Sentinel>, adaptor_sentinel<Sentinel> >
+{
+    return make_sentinel_range(make_filter_iterator(range.begin(), range.end(), filter.get()), adaptor_sentinel<Sentinel>(range.end()));
+}
+
 }  // namespace Range
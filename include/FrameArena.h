@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "MyAlloc.h"
+
+// Ring of Frames arenas for work done in ticks
+// Allocations go to the arena of the current frame, advance_frame() moves to the next arena and resets it,
+// so freeing a frame costs O(1) however many objects it holds. With the default of 2 frames everything
+// allocated in a frame stays valid until the end of the following frame, which lets one tick hand its
+// results to the next, with 1 frame every allocation is released at the end of its own frame
+// Nothing allocated from a frame is destroyed, create() only accepts trivially destructible types and
+// containers using FrameAllocator must be dropped before their frame is reset
+template <class Arena, std::size_t Frames = 2>
+class FrameArena
+{
+    static_assert(Frames > 0, "a frame arena needs at least one frame");
+
+public:
+    using value_type = typename Arena::value_type;
+    using arena_type = Arena;
+
+    static constexpr std::size_t frame_count = Frames;
+    static constexpr std::size_t alignment = Arena::alignment;
+
+    FrameArena() {}
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // capacity of a single frame
+    std::size_t size() const noexcept { return current().size(); }
+    std::size_t used() const noexcept { return current().used(); }
+
+    // number of times advance_frame() has been called
+    std::size_t frame() const noexcept { return m_nFrame; }
+
+    Arena& current() noexcept { return m_Arenas[m_nCurrent]; }
+    const Arena& current() const noexcept { return m_Arenas[m_nCurrent]; }
+
+    bool owns(const void* p) const noexcept
+    {
+        for (const Arena& a : m_Arenas)
+        {
+            if (a.owns(p))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void advance_frame() noexcept
+    {
+        m_nCurrent = (m_nCurrent + 1) % Frames;
+        m_Arenas[m_nCurrent].reset();
+        ++m_nFrame;
+    }
+
+    value_type* allocate(std::size_t n) { return current().allocate(n); }
+
+    // blocks of earlier frames are left alone, they are released when their frame is reset
+    void deallocate(value_type* p, std::size_t n)
+    {
+        if (current().owns(p))
+        {
+            current().deallocate(p, n);
+        }
+    }
+
+    bool try_expand(value_type* p, std::size_t oldSize, std::size_t newSize)
+    {
+        return current().owns(p) && current().try_expand(p, oldSize, newSize);
+    }
+
+    // Construct a T in the current frame, it is never destroyed so T must not need destruction
+    template <class T, class... Args>
+    T* create(Args&&... args)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "objects in a frame are released without being destroyed");
+        static_assert(alignof(T) <= alignment, "over-aligned types are not supported by the arena");
+        return ::new (allocate(sizeof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Default construct an array of n T in the current frame
+    template <class T>
+    T* create_array(std::size_t n)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "objects in a frame are released without being destroyed");
+        static_assert(alignof(T) <= alignment, "over-aligned types are not supported by the arena");
+        return ::new (allocate(n * sizeof(T))) T[n]();
+    }
+
+    // Statistics of the current frame
+    const ArenaStats& stats() const noexcept { return current().stats(); }
+
+private:
+    Arena m_Arenas[Frames];
+    std::size_t m_nCurrent = 0;
+    std::size_t m_nFrame = 0;
+};
+
+// Allocator of T from a frame arena of N bytes per frame, for containers that live for a single tick
+template <class T, std::size_t N = 64 * 1024, class Arena = HeapArena<N>, std::size_t Frames = 2>
+using FrameAllocator = LocalAllocator<T, N, FrameArena<Arena, Frames> >;
+
+inline void FrameArenaTest()
+{
+    struct Particle
+    {
+        float x;
+        float y;
+    };
+
+    constexpr std::size_t N = 4096;
+    FrameArena<HeapArena<N> > frames;
+
+    AllocationCounter::ExpectNoAllocations guard("FrameArenaTest");
+
+    Particle* pLast = nullptr;
+    for (int tick = 0; tick < 100; ++tick)
+    {
+        // the previous frame is still readable
+        if (pLast)
+        {
+            assert(pLast->x == static_cast<float>(tick - 1));
+        }
+
+        Particle* p = frames.create<Particle>(Particle{ static_cast<float>(tick), 0.0f });
+        int* pScratch = frames.create_array<int>(100);
+        assert(pScratch[99] == 0);
+
+        {
+            // a container for this tick only, its buffer grows in place in the frame
+            using Alloc = FrameAllocator<int, N, HeapArena<N> >;
+            SmallVector<int, 0, Alloc> v{ Alloc(frames) };
+            for (int i = 0; i < 200; ++i)
+            {
+                v.push_back(i);
+            }
+            assert(frames.current().owns(v.data()));
+        }
+
+        pLast = p;
+        frames.advance_frame();
+    }
+
+    assert(frames.frame() == 100);
+
+    // with a single frame everything goes at the end of the frame
+    FrameArena<StackArena<256>, 1> single;
+    single.create<int>(1);
+    single.advance_frame();
+    assert(single.used() == 0);
+}
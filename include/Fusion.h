@@ -0,0 +1,491 @@
+#pragma once
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Filter.h"
+#include "Range.h"
+#include "Simd.h"
+#include "SizeHint.h"
+#include "Take.h"
+#include "Transform.h"
+
+// Push-style evaluation of adaptor pipelines
+// Iterating v | filter(p) | transform(f) | take(n) steps through take_iterator<transform_iterator<filter_iterator<...> > >,
+// each layer with its own copy of the base iterator and its own end test. The functions here unwrap the
+// iterators instead: every transform, filter and take becomes a stage around the caller's sink and a single
+// loop drives the innermost iterator, so the compiler sees the whole pipeline as one loop body
+
+// clang-format off
+namespace Range
+{
+// clang-format on
+
+namespace detail {
+
+// Runs a sink over [first, last), the sink returns false to stop early
+// The primary template is the innermost loop, any iterator without a specialization is treated as a source
+// last is an iterator or a sentinel. run_source runs the stages of pipeline over [first, last) of its source
+// instead, which lets Parallel.h hand each thread a slice of the source. A pipeline is splittable when its
+// source is random access and no stage depends on the elements before it
+template <typename Iterator>
+struct fusion_traits
+{
+    using source_iterator = Iterator;
+    static constexpr bool splittable =
+        std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value;
+
+    static const Iterator& source(const Iterator& it) { return it; }
+
+    template <typename Last>
+    static const Last& source_end(const Last& last)
+    {
+        return last;
+    }
+
+    template <typename Last, typename Sink>
+    static void run_source(const Iterator& /*pipeline*/, Iterator first, const Last& last, Sink& sink)
+    {
+        for (; first != last; ++first)
+        {
+            if (!sink(*first))
+            {
+                return;
+            }
+        }
+    }
+
+    template <typename Last, typename Sink>
+    static void run(const Iterator& first, const Last& last, Sink& sink)
+    {
+        run_source(first, first, last, sink);
+    }
+};
+
+template <typename BaseIterator, typename UnaryOperation>
+struct fusion_traits<transform_iterator<BaseIterator, UnaryOperation> >
+{
+    using iterator = transform_iterator<BaseIterator, UnaryOperation>;
+    using source_iterator = typename fusion_traits<BaseIterator>::source_iterator;
+    static constexpr bool splittable = fusion_traits<BaseIterator>::splittable;
+
+    static source_iterator source(const iterator& it) { return fusion_traits<BaseIterator>::source(it.base()); }
+
+    // last is the end iterator or the adaptor_sentinel of the transform, or unreachable below a clamped take
+    template <typename Last>
+    static auto source_end(const Last& last) -> decltype(fusion_traits<BaseIterator>::source_end(sentinel_base(last)))
+    {
+        return fusion_traits<BaseIterator>::source_end(sentinel_base(last));
+    }
+
+    template <typename SourceEnd, typename Sink>
+    static void run_source(const iterator& pipeline, const source_iterator& first, const SourceEnd& last, Sink& sink)
+    {
+        UnaryOperation op = pipeline.operation();
+        auto stage = [&op, &sink](auto&& value) { return sink(op(std::forward<decltype(value)>(value))); };
+        fusion_traits<BaseIterator>::run_source(pipeline.base(), first, last, stage);
+    }
+
+    template <typename Last, typename Sink>
+    static void run(const iterator& first, const Last& last, Sink& sink)
+    {
+        run_source(first, source(first), source_end(last), sink);
+    }
+};
+
+template <typename BaseIterator, typename UnaryPredicate, typename BaseSentinel>
+struct fusion_traits<filter_iterator<BaseIterator, UnaryPredicate, BaseSentinel> >
+{
+    using iterator = filter_iterator<BaseIterator, UnaryPredicate, BaseSentinel>;
+    using source_iterator = typename fusion_traits<BaseIterator>::source_iterator;
+    static constexpr bool splittable = fusion_traits<BaseIterator>::splittable;
+
+    static source_iterator source(const iterator& it) { return fusion_traits<BaseIterator>::source(it.base()); }
+
+    // last is the end iterator or the adaptor_sentinel of the filter, or unreachable below a clamped take
+    template <typename Last>
+    static auto source_end(const Last& last) -> decltype(fusion_traits<BaseIterator>::source_end(sentinel_base(last)))
+    {
+        return fusion_traits<BaseIterator>::source_end(sentinel_base(last));
+    }
+
+    template <typename SourceEnd, typename Sink>
+    static void run_source(const iterator& pipeline, const source_iterator& first, const SourceEnd& last, Sink& sink)
+    {
+        UnaryPredicate pred = pipeline.predicate();
+        auto stage = [&pred, &sink](auto&& value) { return pred(value) ? sink(std::forward<decltype(value)>(value)) : true; };
+        fusion_traits<BaseIterator>::run_source(pipeline.base(), first, last, stage);
+    }
+
+    template <typename Last, typename Sink>
+    static void run(const iterator& first, const Last& last, Sink& sink)
+    {
+        run_source(first, source(first), source_end(last), sink);
+    }
+};
+
+// take counts the elements before it, so a take is the source of the stages around it and is never split
+template <typename BaseIterator>
+struct fusion_traits<take_iterator<BaseIterator> >
+{
+    using iterator = take_iterator<BaseIterator>;
+    using source_iterator = iterator;
+    static constexpr bool splittable = false;
+
+    static const iterator& source(const iterator& it) { return it; }
+
+    template <typename Last>
+    static const Last& source_end(const Last& last)
+    {
+        return last;
+    }
+
+    template <typename Last, typename Sink>
+    static void run_source(const iterator& /*pipeline*/, const iterator& first, const Last& last, Sink& sink)
+    {
+        run(first, last, sink);
+    }
+
+    // last is the take_sentinel, the count left in first bounds the loop and the base end is checked below it
+    template <typename Last, typename Sink>
+    static void run(const iterator& first, const Last& last, Sink& sink)
+    {
+        size_t remaining = first.count();
+        if (remaining == 0)
+        {
+            return;
+        }
+        auto stage = [&remaining, &sink](auto&& value) { return sink(std::forward<decltype(value)>(value)) && --remaining != 0; };
+        fusion_traits<BaseIterator>::run(first.base(), last.base(), stage);
+    }
+};
+
+// Block evaluation, used by to_vector
+// When the source is contiguous and every stage produces an arithmetic type, the stages run a block of
+// fusion_block_size elements at a time instead: a transform fills an array with a loop the compiler can
+// vectorize, a filter computes its flags the same way and compacts the block with Simd::Compress. The sink
+// receives (data, count) for every block and appends it with one insert
+
+constexpr std::size_t fusion_block_size = 256;
+
+template <typename T>
+struct is_block_type : std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>
+{
+};
+
+// pointers and vector iterators, C++17 has no way to ask an iterator whether it is contiguous
+template <typename Iterator>
+struct is_contiguous_iterator
+    : std::integral_constant<bool,
+                             std::is_pointer<Iterator>::value ||
+                                 std::is_same<Iterator, typename std::vector<typename std::iterator_traits<Iterator>::value_type>::iterator>::value ||
+                                 std::is_same<Iterator, typename std::vector<typename std::iterator_traits<Iterator>::value_type>::const_iterator>::value>
+{
+};
+
+// Call fn(i) for i in [0, n), a whole block gets a loop of fixed trip count that the compiler vectorizes
+// even at its cheapest cost model
+template <typename Function>
+inline void for_block(std::size_t n, Function fn)
+{
+    if (n == fusion_block_size)
+    {
+        for (std::size_t i = 0; i < fusion_block_size; ++i)
+        {
+            fn(i);
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            fn(i);
+        }
+    }
+}
+
+template <typename Iterator>
+struct block_traits
+{
+    using value_type = typename std::remove_cv<typename std::iterator_traits<Iterator>::value_type>::type;
+    static constexpr bool enabled = is_contiguous_iterator<Iterator>::value && is_block_type<value_type>::value;
+
+    template <typename Sink>
+    static void run(const Iterator& first, const Iterator& last, Sink& sink)
+    {
+        const std::size_t size = static_cast<std::size_t>(last - first);
+        if (size == 0)
+        {
+            return;
+        }
+        const value_type* data = std::addressof(*first);
+        for (std::size_t i = 0; i < size; i += fusion_block_size)
+        {
+            if (!sink(data + i, size - i < fusion_block_size ? size - i : fusion_block_size))
+            {
+                return;
+            }
+        }
+    }
+};
+
+template <typename BaseIterator, typename UnaryOperation>
+struct block_traits<transform_iterator<BaseIterator, UnaryOperation> >
+{
+    using base = block_traits<BaseIterator>;
+    using value_type = typename std::decay<decltype(std::declval<UnaryOperation&>()(std::declval<const typename base::value_type&>()))>::type;
+    static constexpr bool enabled = base::enabled && is_block_type<value_type>::value;
+
+    template <typename Sink>
+    static void run(const transform_iterator<BaseIterator, UnaryOperation>& first, const transform_iterator<BaseIterator, UnaryOperation>& last,
+                    Sink& sink)
+    {
+        UnaryOperation op = first.operation();
+        auto stage = [&op, &sink](const typename base::value_type* in, std::size_t n) {
+            value_type out[fusion_block_size];
+            for_block(n, [&](std::size_t i) { out[i] = op(in[i]); });
+            return sink(static_cast<const value_type*>(out), n);
+        };
+        base::run(first.base(), last.base(), stage);
+    }
+};
+
+template <typename BaseIterator, typename UnaryPredicate, typename BaseSentinel>
+struct block_traits<filter_iterator<BaseIterator, UnaryPredicate, BaseSentinel> >
+{
+    using base = block_traits<BaseIterator>;
+    using value_type = typename base::value_type;
+    static constexpr bool enabled = base::enabled && std::is_same<BaseIterator, BaseSentinel>::value;
+
+    template <typename Sink>
+    static void run(const filter_iterator<BaseIterator, UnaryPredicate, BaseSentinel>& first,
+                    const filter_iterator<BaseIterator, UnaryPredicate, BaseSentinel>& last, Sink& sink)
+    {
+        UnaryPredicate pred = first.predicate();
+        auto stage = [&pred, &sink](const value_type* in, std::size_t n) {
+            bool keep[fusion_block_size];
+            for_block(n, [&](std::size_t i) { keep[i] = pred(in[i]) ? true : false; });
+            value_type out[fusion_block_size + Simd::CompressPadding];
+            const std::size_t kept = Simd::Compress(in, keep, n, out);
+            return kept == 0 || sink(static_cast<const value_type*>(out), kept);
+        };
+        base::run(first.base(), last.base(), stage);
+    }
+};
+
+// take stops part way through a block, it is never evaluated in blocks
+template <typename BaseIterator>
+struct block_traits<take_iterator<BaseIterator> >
+{
+    using value_type = typename std::iterator_traits<BaseIterator>::value_type;
+    static constexpr bool enabled = false;
+};
+
+template <typename Rng>
+struct is_block_range
+    : std::integral_constant<bool, block_traits<typename std::decay<decltype(std::declval<const Rng&>().begin())>::type>::enabled &&
+                                       std::is_same<decltype(std::declval<const Rng&>().begin()), decltype(std::declval<const Rng&>().end())>::value>
+{
+};
+
+template <typename Rng, typename Sink>
+void fuse_blocks(const Rng& range, Sink& sink)
+{
+    block_traits<typename std::decay<decltype(range.begin())>::type>::run(range.begin(), range.end(), sink);
+}
+
+template <typename Rng>
+using range_iterator_t = typename std::decay<decltype(std::declval<const Rng&>().begin())>::type;
+
+template <typename Rng>
+using range_value_t = typename std::iterator_traits<range_iterator_t<Rng> >::value_type;
+
+template <typename Rng, typename Sink>
+void fuse(const Rng& range, Sink& sink)
+{
+    fusion_traits<range_iterator_t<Rng> >::run(range.begin(), range.end(), sink);
+}
+
+template <typename Container, typename = void>
+struct has_reserve : std::false_type
+{
+};
+
+template <typename Container>
+struct has_reserve<Container, std::void_t<decltype(std::declval<Container&>().reserve(std::size_t()))> > : std::true_type
+{
+};
+
+template <typename Container, typename = void>
+struct has_push_back : std::false_type
+{
+};
+
+template <typename Container>
+struct has_push_back<Container, std::void_t<decltype(std::declval<Container&>().push_back(std::declval<typename Container::value_type>()))> >
+    : std::true_type
+{
+};
+
+// insert(pos, first, last) of a sequence, which appends a block with a single copy
+template <typename Container, typename Pointer, typename = void>
+struct has_range_insert : std::false_type
+{
+};
+
+template <typename Container, typename Pointer>
+struct has_range_insert<Container, Pointer,
+                        std::void_t<decltype(std::declval<Container&>().insert(std::declval<Container&>().end(), std::declval<Pointer>(), std::declval<Pointer>()))> >
+    : std::true_type
+{
+};
+
+template <typename Container, typename Rng>
+struct is_block_collect
+    : std::integral_constant<bool, is_block_range<Rng>::value &&
+                                       has_range_insert<Container, const typename block_traits<range_iterator_t<Rng> >::value_type*>::value>
+{
+};
+
+// Append the elements of the range to c
+// The container is reserved once when the pipeline reports its exact size, through transform, take and
+// reverse. The upper bound of a filter is not reserved, a selective filter would take the room of its whole
+// source. A contiguous arithmetic pipeline is then appended a block at a time, any other one element at a time
+template <typename Container, typename Rng>
+void collect(Container& c, const Rng& range)
+{
+    if constexpr (has_reserve<Container>::value)
+    {
+        const size_hint hint = range_size(range);
+        if (hint.kind == size_kind::exact)
+        {
+            c.reserve(c.size() + hint.size);
+        }
+    }
+
+    if constexpr (is_block_collect<Container, Rng>::value)
+    {
+        auto sink = [&c](const auto* data, std::size_t n) {
+            c.insert(c.end(), data, data + n);
+            return true;
+        };
+        fuse_blocks(range, sink);
+    }
+    else if constexpr (has_push_back<Container>::value)
+    {
+        auto sink = [&c](auto&& value) {
+            c.push_back(std::forward<decltype(value)>(value));
+            return true;
+        };
+        fuse(range, sink);
+    }
+    else
+    {
+        // associative containers
+        auto sink = [&c](auto&& value) {
+            c.insert(std::forward<decltype(value)>(value));
+            return true;
+        };
+        fuse(range, sink);
+    }
+}
+
+}  // namespace detail
+
+// Call fn on every element of the range
+template <typename Rng, typename Function>
+void for_each(const Rng& range, Function fn)
+{
+    auto sink = [&fn](auto&& value) {
+        fn(std::forward<decltype(value)>(value));
+        return true;
+    };
+    detail::fuse(range, sink);
+}
+
+// Copy the elements of the range into a vector, in blocks when the pipeline allows it
+template <typename Rng>
+std::vector<detail::range_value_t<Rng> > to_vector(const Rng& range)
+{
+    std::vector<detail::range_value_t<Rng> > result;
+    detail::collect(result, range);
+    return result;
+}
+
+// Copy the elements of the range into a new Container
+template <typename Container, typename Rng>
+Container to(const Rng& range)
+{
+    Container result;
+    detail::collect(result, range);
+    return result;
+}
+
+// Copy the elements of the range into a new Container of the range's value type, to<std::vector>(range)
+template <template <typename...> class Container, typename Rng>
+Container<detail::range_value_t<Rng> > to(const Rng& range)
+{
+    return to<Container<detail::range_value_t<Rng> > >(range);
+}
+
+// clang-format off
+template <typename Container>
+class to_holder
+{
+};
+
+template <template <typename...> class Container>
+class to_template_holder
+{
+};
+// clang-format on
+
+// Construct the collect adaptor, range | to<Container>()
+template <typename Container>
+to_holder<Container> to()
+{
+    return to_holder<Container>();
+}
+
+// Construct the collect adaptor deducing the value type, range | to<std::vector>()
+template <template <typename...> class Container>
+to_template_holder<Container> to()
+{
+    return to_template_holder<Container>();
+}
+
+template <typename Rng, typename Container>
+Container operator|(const Rng& range, to_holder<Container>)
+{
+    return to<Container>(range);
+}
+
+template <typename Rng, template <typename...> class Container>
+Container<detail::range_value_t<Rng> > operator|(const Rng& range, to_template_holder<Container>)
+{
+    return to<Container>(range);
+}
+
+// Fold the elements of the range into init from left to right
+// A reduction is not evaluated in blocks: the fused loop has no output to compact, the compiler if-converts
+// and vectorizes it as it is and the block arrays would only add passes over the data
+template <typename Rng, typename T, typename BinaryOperation>
+T reduce(const Rng& range, T init, BinaryOperation op)
+{
+    auto sink = [&init, &op](auto&& value) {
+        init = op(std::move(init), std::forward<decltype(value)>(value));
+        return true;
+    };
+    detail::fuse(range, sink);
+    return init;
+}
+
+template <typename Rng, typename T>
+T reduce(const Rng& range, T init)
+{
+    return reduce(range, std::move(init), std::plus<>());
+}
+
+}  // namespace Range
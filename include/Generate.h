@@ -1,6 +1,7 @@
 #pragma once
 #include "IteratorTraits.h"
 #include "Range.h"
+#include "Sentinel.h"
 
 // clang-format off
 namespace Range
@@ -17,9 +18,8 @@ public:
     using pointer = value_type*;
     using reference = const value_type&;
 
-    explicit generate_iterator(NullaryOperation op, bool end)
+    explicit generate_iterator(NullaryOperation op)
         : m_op(op)
-        , m_bEnd(end)
     {
     }
 
@@ -38,8 +38,8 @@ public:
     // Required by InputIterator
     value_type operator*()
     {
-        // apply the operation when invalid and not at the end
-        if (!m_bValid && !m_bEnd)
+        // apply the operation when invalid
+        if (!m_bValid)
         {
             m_Result = m_op();
             m_bValid = true;
@@ -47,8 +47,9 @@ public:
         return m_Result;
     }
 
-    bool operator==(const generate_iterator&) { return false; }
-    bool operator!=(const generate_iterator& rhs) { return !(m_bEnd && rhs.m_bEnd); }
+    // the sequence never ends, the range's end is an unreachable_sentinel
+    bool operator==(const generate_iterator&) const { return false; }
+    bool operator!=(const generate_iterator&) const { return true; }
 
     // Required by ForwardIterator
     generate_iterator() = default;
@@ -68,22 +69,20 @@ private:
 
     // cache validation flag
     bool m_bValid = false;
-
-    // flag to indicate if this is the end() iterator
-    bool m_bEnd = false;
 };
 
 template <typename NullaryOperation>
-generate_iterator<NullaryOperation> make_generate_iterator(NullaryOperation op, bool EndSentinel)
+generate_iterator<NullaryOperation> make_generate_iterator(NullaryOperation op)
 {
     static_assert(is_iterator<generate_iterator<NullaryOperation> >::value, "is_iterator failed");
-    return generate_iterator<NullaryOperation>(op, EndSentinel);
+    return generate_iterator<NullaryOperation>(op);
 }
 
+// Infinite range of the results of op, the end carries no copy of op
 template <typename NullaryOperation>
-auto generate(NullaryOperation op) -> IteratorRange<generate_iterator<NullaryOperation> >
+auto generate(NullaryOperation op) -> SentinelRange<generate_iterator<NullaryOperation>, unreachable_sentinel>
 {
-    return make_range(make_generate_iterator(op, false), make_generate_iterator(op, true));
+    return make_sentinel_range(make_generate_iterator(op), unreachable_sentinel());
 }
 
 template <typename NullaryOperation>
@@ -129,8 +128,8 @@ public:
         return m_Result;
     }
 
-    bool operator==(const generate_n_iterator& rhs) { return m_uCurrent == rhs.m_uCurrent; }
-    bool operator!=(const generate_n_iterator& rhs) { return !(*this == rhs); }
+    bool operator==(const generate_n_iterator& rhs) const { return m_uCurrent == rhs.m_uCurrent; }
+    bool operator!=(const generate_n_iterator& rhs) const { return !(*this == rhs); }
 
     // Required by ForwardIterator
     generate_n_iterator() = default;
@@ -142,6 +141,9 @@ public:
         return temp;
     }
 
+    // index of the element the iterator is at
+    size_t position() const { return m_uCurrent; }
+
 private:
     NullaryOperation m_op{};
 
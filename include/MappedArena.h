@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include "Arena.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// storage of N bytes in reserved virtual memory
+// address space is reserved up front and pages are only committed when the bump pointer reaches them,
+// so a large arena costs the memory it uses. On Linux the reservation is aligned to 2MB and marked for
+// transparent huge pages, which cuts TLB misses when the working set is hundreds of MB
+template <std::size_t N>
+class MappedStorage
+{
+public:
+    using value_type = std::uint8_t;
+
+    static constexpr std::size_t alignment = arena_alignment;
+    static constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+    MappedStorage()
+    {
+        m_pBuffer = reserve();
+        m_pCommitted = m_pBuffer;
+    }
+    ~MappedStorage()
+    {
+        release();
+        m_pBuffer = nullptr;
+    }
+    MappedStorage(const MappedStorage&) = delete;
+    MappedStorage& operator=(const MappedStorage&) = delete;
+
+    static constexpr std::size_t size() noexcept { return N; }
+    value_type* data() noexcept { return m_pBuffer; }
+    const value_type* data() const noexcept { return m_pBuffer; }
+
+#if defined(_WIN32)
+    bool commit(std::size_t used) noexcept
+    {
+        value_type* pEnd = m_pBuffer + used;
+        if (pEnd <= m_pCommitted)
+        {
+            return true;
+        }
+
+        std::size_t target = (used + commit_size - 1) & ~(commit_size - 1);
+        value_type* pTarget = m_pBuffer + (target < N ? target : N);
+        if (::VirtualAlloc(m_pCommitted, static_cast<std::size_t>(pTarget - m_pCommitted), MEM_COMMIT, PAGE_READWRITE) == nullptr)
+        {
+            return false;
+        }
+        m_pCommitted = pTarget;
+        return true;
+    }
+
+    // return the touched pages to the OS, the address space stays reserved
+    void decommit() noexcept
+    {
+        if (m_pCommitted != m_pBuffer)
+        {
+            ::VirtualFree(m_pBuffer, static_cast<std::size_t>(m_pCommitted - m_pBuffer), MEM_DECOMMIT);
+            m_pCommitted = m_pBuffer;
+        }
+    }
+
+private:
+    // commit in 64KB steps, the allocation granularity of VirtualAlloc
+    static constexpr std::size_t commit_size = 64 * 1024;
+
+    static value_type* reserve()
+    {
+        void* p = ::VirtualAlloc(nullptr, N, MEM_RESERVE, PAGE_READWRITE);
+        if (p == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<value_type*>(p);
+    }
+
+    void release() noexcept
+    {
+        if (m_pBuffer)
+        {
+            ::VirtualFree(m_pBuffer, 0, MEM_RELEASE);
+        }
+    }
+#else
+    // the kernel commits anonymous pages on first touch
+    bool commit(std::size_t used) noexcept
+    {
+        if (m_pBuffer + used > m_pCommitted)
+        {
+            m_pCommitted = m_pBuffer + used;
+        }
+        return true;
+    }
+
+    // return the touched pages to the OS, the address space stays reserved
+    void decommit() noexcept
+    {
+        if (m_pCommitted != m_pBuffer)
+        {
+            const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            const std::size_t length = (static_cast<std::size_t>(m_pCommitted - m_pBuffer) + page - 1) & ~(page - 1);
+            ::madvise(m_pBuffer, length < mapped_size() ? length : mapped_size(), MADV_DONTNEED);
+            m_pCommitted = m_pBuffer;
+        }
+    }
+
+private:
+    // round the mapping up to whole huge pages when the arena is large enough to use them
+    static constexpr std::size_t mapped_size() { return N < huge_page_size ? N : (N + huge_page_size - 1) & ~(huge_page_size - 1); }
+
+    value_type* reserve()
+    {
+        // over-reserve by a huge page so the arena can start on a huge page boundary
+        const std::size_t reserved = mapped_size() + huge_page_size;
+        void* p = ::mmap(nullptr, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+
+        uintptr_t first = reinterpret_cast<uintptr_t>(p);
+        uintptr_t aligned = (first + huge_page_size - 1) & ~(uintptr_t(huge_page_size) - 1);
+        uintptr_t last = first + reserved;
+
+        // trim the unaligned head and the unused tail
+        if (aligned > first)
+        {
+            ::munmap(p, aligned - first);
+        }
+        if (last > aligned + mapped_size())
+        {
+            ::munmap(reinterpret_cast<void*>(aligned + mapped_size()), last - aligned - mapped_size());
+        }
+
+#if defined(MADV_HUGEPAGE)
+        if (mapped_size() >= huge_page_size)
+        {
+            ::madvise(reinterpret_cast<void*>(aligned), mapped_size(), MADV_HUGEPAGE);
+        }
+#endif
+        return reinterpret_cast<value_type*>(aligned);
+    }
+
+    void release() noexcept
+    {
+        if (m_pBuffer)
+        {
+            ::munmap(m_pBuffer, mapped_size());
+        }
+    }
+#endif
+
+    value_type* m_pBuffer = nullptr;
+
+    // high water mark of the pages handed to the OS to commit
+    value_type* m_pCommitted = nullptr;
+};
+
+// create a memory arena of N bytes in reserved virtual memory, reset() returns its pages to the OS
+template <std::size_t N>
+using MappedArena = BasicArena<MappedStorage<N> >;
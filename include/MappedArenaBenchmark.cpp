@@ -0,0 +1,91 @@
+#if defined(_WIN32)
+#pragma warning(disable : 4189)  // local variable is initialized but not referenced
+#endif
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include "Benchmark.h"
+#include "MappedArena.h"
+#include "MyAlloc.h"
+
+namespace MappedArenaBenchmark {
+
+static constexpr std::size_t VectorElements = 32 * 1024 * 1024;  // 256MB of uint64_t
+static constexpr std::size_t MapElements = 2 * 1024 * 1024;
+static constexpr std::size_t MapArenaSize = 256 * 1024 * 1024;
+static constexpr std::size_t Lookups = 8 * 1024 * 1024;
+static constexpr std::size_t MapLookups = MapElements;
+
+// xorshift, cheap enough not to dominate the memory accesses being measured
+static std::uint64_t NextRandom(std::uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Fill a vector, then read it in a random order so most accesses touch a different page
+template <template <std::size_t> class ArenaT>
+static void VectorWorkload()
+{
+    // the arena is too large for the stack
+    auto pVector = std::make_unique<MyVector<std::uint64_t, VectorElements, ArenaT> >();
+    auto& v = *pVector;
+    v.reserve(VectorElements);
+    for (std::size_t i = 0; i < VectorElements; ++i)
+    {
+        v.push_back(i);
+    }
+
+    std::uint64_t state = 88172645463325252ull;
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i < Lookups; ++i)
+    {
+        sum += v[NextRandom(state) % VectorElements];
+    }
+    Benchmark::DoNotOptimize(sum);
+}
+
+template <class Arena>
+using BenchMap = std::map<std::uint64_t, std::uint64_t, std::less<std::uint64_t>,
+                          LocalAllocator<std::pair<const std::uint64_t, std::uint64_t>, MapArenaSize, Arena> >;
+
+// Build a map of random keys, then look keys up in a random order
+template <class Arena>
+static void MapWorkload()
+{
+    auto pArena = std::make_unique<Arena>();
+    BenchMap<Arena> m{ *pArena };
+
+    std::uint64_t state = 88172645463325252ull;
+    for (std::size_t i = 0; i < MapElements; ++i)
+    {
+        m.emplace(NextRandom(state), i);
+    }
+
+    // replay the insertion sequence so every lookup hits a node in a random position
+    std::uint64_t found = 0;
+    state = 88172645463325252ull;
+    for (std::size_t i = 0; i < MapLookups; ++i)
+    {
+        found += m.count(NextRandom(state));
+    }
+    Benchmark::DoNotOptimize(found);
+}
+
+void RunMappedArenaBenchmark()
+{
+    using Benchmark::Measure;
+    using Benchmark::Report;
+
+    Report(Measure("MappedArena", "MyVector/HeapArena", VectorElements, VectorElements + Lookups, VectorWorkload<HeapArena>));
+    Report(Measure("MappedArena", "MyVector/MappedArena", VectorElements, VectorElements + Lookups, VectorWorkload<MappedArena>));
+
+    Report(Measure("MappedArena", "map/HeapArena", MapElements, MapElements + MapLookups, MapWorkload<HeapArena<MapArenaSize> >));
+    Report(Measure("MappedArena", "map/MappedArena", MapElements, MapElements + MapLookups, MapWorkload<MappedArena<MapArenaSize> >));
+}
+
+}  // namespace MappedArenaBenchmark
@@ -0,0 +1,351 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+#include "Fusion.h"
+#include "IteratorTraits.h"
+#include "Range.h"
+
+// range | memoize() computes every element of range at most once, however many times the view is traversed
+// transform recomputes its operation on every dereference, which a multi-pass algorithm over an expensive
+// transform pays for on every pass. The memoized view keeps the elements it has produced in a cache shared
+// by the view and its iterators
+// Over a random-access base of known size the cache has a slot per position, filled the first time the
+// position is read, and the view is random access. Over any other base the cache is the prefix read so far,
+// extended as iterators move past it, and the view is a forward range
+// The cache lives as long as the view or any of its iterators. The slot cache allocates an empty slot for
+// every position of the base when the view is built, the prefix cache grows to the number of elements read.
+// It is not synchronized, a memoized view must not be read from several threads at once
+
+// clang-format off
+namespace Range
+{
+// clang-format on
+
+namespace detail {
+
+// Cache with one slot per position of a random-access base, all allocated up front
+template <typename BaseIterator>
+class memoize_slots final
+{
+public:
+    using value_type = typename std::decay<decltype(*std::declval<BaseIterator&>())>::type;
+    using iterator_category = std::random_access_iterator_tag;
+
+    memoize_slots(BaseIterator first, BaseIterator last)
+        : m_first(first)
+        , m_Slots(static_cast<std::size_t>(last - first))
+    {
+    }
+
+    const value_type& get(std::size_t index)
+    {
+        std::optional<value_type>& slot = m_Slots[index];
+        if (!slot)
+        {
+            slot.emplace(*(m_first + index));
+        }
+        return *slot;
+    }
+
+    std::size_t size() const { return m_Slots.size(); }
+
+private:
+    BaseIterator m_first;
+    std::vector<std::optional<value_type> > m_Slots;
+};
+
+// Cache of the prefix of any other base read so far
+// A deque keeps the elements already handed out in place while the prefix grows
+template <typename BaseIterator, typename BaseSentinel>
+class memoize_prefix final
+{
+public:
+    using value_type = typename std::decay<decltype(*std::declval<BaseIterator&>())>::type;
+    using iterator_category = std::forward_iterator_tag;
+
+    memoize_prefix(BaseIterator first, BaseSentinel last)
+        : m_iterator(first)
+        , m_last(last)
+    {
+    }
+
+    const value_type& get(std::size_t index)
+    {
+        fill(index);
+        return m_Values[index];
+    }
+
+    // Whether the base ends before index
+    bool done(std::size_t index) { return !fill(index); }
+
+private:
+    // read the base up to index, false when it ends first
+    bool fill(std::size_t index)
+    {
+        while (m_Values.size() <= index)
+        {
+            if (m_iterator == m_last)
+            {
+                return false;
+            }
+            m_Values.push_back(*m_iterator);
+            ++m_iterator;
+        }
+        return true;
+    }
+
+    BaseIterator m_iterator;
+    BaseSentinel m_last;
+    std::deque<value_type> m_Values;
+};
+
+}  // namespace detail
+
+// Position in a memoized view, Cache is memoize_slots or memoize_prefix
+// Over a prefix cache the end iterator has no position, it compares equal to the iterators the base has
+// ended at
+template <typename Cache>
+class memoize_iterator final
+{
+    static constexpr bool random_access = std::is_same<typename Cache::iterator_category, std::random_access_iterator_tag>::value;
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+public:
+    using iterator_category = typename Cache::iterator_category;
+    using value_type = typename Cache::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    explicit memoize_iterator(std::shared_ptr<Cache> cache, std::size_t index)
+        : m_pCache(std::move(cache))
+        , m_nIndex(index)
+    {
+    }
+
+    // End of a view over a prefix cache
+    explicit memoize_iterator(std::shared_ptr<Cache> cache)
+        : m_pCache(std::move(cache))
+        , m_nIndex(npos)
+    {
+    }
+
+    // Iterator requires CopyConstructible, CopyAssignable, Destructible
+    ~memoize_iterator() = default;
+    memoize_iterator(const memoize_iterator&) = default;
+    memoize_iterator& operator=(const memoize_iterator&) = default;
+
+    memoize_iterator& operator++()
+    {
+        ++m_nIndex;
+        return *this;
+    }
+
+    // Required by InputIterator
+    reference operator*() const { return m_pCache->get(m_nIndex); }
+    pointer operator->() const { return &m_pCache->get(m_nIndex); }
+
+    bool operator==(const memoize_iterator& rhs) const
+    {
+        if constexpr (random_access)
+        {
+            return m_nIndex == rhs.m_nIndex;
+        }
+        else
+        {
+            if (m_nIndex == npos || rhs.m_nIndex == npos)
+            {
+                return at_end() && rhs.at_end();
+            }
+            return m_nIndex == rhs.m_nIndex;
+        }
+    }
+
+    bool operator!=(const memoize_iterator& rhs) const { return !(*this == rhs); }
+
+    // Required by ForwardIterator
+    memoize_iterator() = default;
+
+    memoize_iterator operator++(int)
+    {
+        memoize_iterator temp(*this);
+        ++(*this);
+        return temp;
+    }
+
+    // Required by BidirectionalIterator and RandomAccessIterator, over a slot cache only
+    memoize_iterator& operator--()
+    {
+        static_assert(random_access, "memoize over a forward range is a forward range");
+        --m_nIndex;
+        return *this;
+    }
+
+    memoize_iterator operator--(int)
+    {
+        memoize_iterator temp(*this);
+        --(*this);
+        return temp;
+    }
+
+    // r += n
+    memoize_iterator& operator+=(difference_type n)
+    {
+        static_assert(random_access, "memoize over a forward range is a forward range");
+        m_nIndex += n;
+        return *this;
+    }
+
+    // a + n
+    memoize_iterator operator+(difference_type n) const
+    {
+        memoize_iterator temp(*this);
+        return temp += n;
+    }
+
+    // n + a
+    friend memoize_iterator operator+(difference_type n, const memoize_iterator& rhs) { return rhs + n; }
+
+    // r -= n
+    memoize_iterator& operator-=(difference_type n) { return *this += -n; }
+
+    // a - n
+    memoize_iterator operator-(difference_type n) const
+    {
+        memoize_iterator temp(*this);
+        return temp -= n;
+    }
+
+    // b - a
+    difference_type operator-(const memoize_iterator& rhs) const
+    {
+        static_assert(random_access, "memoize over a forward range is a forward range");
+        return static_cast<difference_type>(m_nIndex) - static_cast<difference_type>(rhs.m_nIndex);
+    }
+
+    // a[n]
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    friend bool operator<(const memoize_iterator& lhs, const memoize_iterator& rhs) { return lhs - rhs < 0; }
+    friend bool operator>(const memoize_iterator& lhs, const memoize_iterator& rhs) { return rhs < lhs; }
+    friend bool operator<=(const memoize_iterator& lhs, const memoize_iterator& rhs) { return !(rhs < lhs); }
+    friend bool operator>=(const memoize_iterator& lhs, const memoize_iterator& rhs) { return !(lhs < rhs); }
+
+private:
+    bool at_end() const { return m_nIndex == npos || m_pCache->done(m_nIndex); }
+
+    std::shared_ptr<Cache> m_pCache;
+    std::size_t m_nIndex = 0;
+};
+
+// View of a memoized range, copies of the view share its cache
+template <typename Cache>
+class memoize_view final
+{
+public:
+    using iterator = memoize_iterator<Cache>;
+    using const_iterator = iterator;
+    using value_type = typename Cache::value_type;
+
+    explicit memoize_view(std::shared_ptr<Cache> cache)
+        : m_pCache(std::move(cache))
+    {
+    }
+
+    iterator begin() const { return iterator(m_pCache, 0); }
+
+    iterator end() const
+    {
+        if constexpr (std::is_same<typename Cache::iterator_category, std::random_access_iterator_tag>::value)
+        {
+            return iterator(m_pCache, m_pCache->size());
+        }
+        else
+        {
+            return iterator(m_pCache);
+        }
+    }
+
+private:
+    std::shared_ptr<Cache> m_pCache;
+};
+
+namespace detail {
+
+// The iterators share the cache, so a temporary memoized view may be zipped
+template <typename Cache>
+struct is_view<memoize_view<Cache> > : std::true_type
+{
+};
+
+template <typename Iterator, typename Sentinel>
+auto make_memoize_view(Iterator first, Sentinel last, std::true_type) -> memoize_view<memoize_slots<Iterator> >
+{
+    return memoize_view<memoize_slots<Iterator> >(std::make_shared<memoize_slots<Iterator> >(first, last));
+}
+
+template <typename Iterator, typename Sentinel>
+auto make_memoize_view(Iterator first, Sentinel last, std::false_type) -> memoize_view<memoize_prefix<Iterator, Sentinel> >
+{
+    return memoize_view<memoize_prefix<Iterator, Sentinel> >(std::make_shared<memoize_prefix<Iterator, Sentinel> >(first, last));
+}
+
+template <typename Iterator, typename Sentinel>
+using memoize_is_sized = std::integral_constant<bool, std::is_same<Iterator, Sentinel>::value && is_random_access_iterator<Iterator>::value>;
+
+// The cache is written on read, a memoized pipeline is never split across threads
+template <typename Cache>
+struct fusion_traits<memoize_iterator<Cache> >
+{
+    using iterator = memoize_iterator<Cache>;
+    using source_iterator = iterator;
+    static constexpr bool splittable = false;
+
+    static const iterator& source(const iterator& it) { return it; }
+
+    template <typename Last>
+    static const Last& source_end(const Last& last)
+    {
+        return last;
+    }
+
+    template <typename Last, typename Sink>
+    static void run_source(const iterator& /*pipeline*/, iterator first, const Last& last, Sink& sink)
+    {
+        for (; first != last; ++first)
+        {
+            if (!sink(*first))
+            {
+                return;
+            }
+        }
+    }
+
+    template <typename Last, typename Sink>
+    static void run(const iterator& first, const Last& last, Sink& sink)
+    {
+        run_source(first, first, last, sink);
+    }
+};
+
+}  // namespace detail
+
+// clang-format off
+struct memoizer {};
+inline memoizer memoize() { return memoizer{}; }
+// clang-format on
+
+// Construct view that computes every element of the range at most once
+template <typename Rng>
+auto operator|(const Rng& range, memoizer)
+    -> decltype(detail::make_memoize_view(range.begin(), range.end(), detail::memoize_is_sized<decltype(range.begin()), decltype(range.end())>()))
+{
+    return detail::make_memoize_view(range.begin(), range.end(), detail::memoize_is_sized<decltype(range.begin()), decltype(range.end())>());
+}
+
+}  // namespace Range
@@ -1,137 +1,27 @@
 #pragma once
 
-#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <map>
+#include <new>
 #include <scoped_allocator>
-
-// create a dynamic memory arena on the heap of N bytes
-template <std::size_t N>
-class HeapArena
-{
-public:
-    using value_type = uint8_t;
-
-    HeapArena()
-    {
-        m_pBuffer = static_cast<value_type*>(::operator new(N));
-        m_pNext = m_pBuffer;
-    }
-    ~HeapArena()
-    {
-        ::operator delete(m_pBuffer);
-        m_pBuffer = nullptr;
-        m_pNext = nullptr;
-    }
-    HeapArena(const HeapArena&) = delete;
-    HeapArena& operator=(const HeapArena&) = delete;
-
-    static constexpr std::size_t size() { return N; }
-
-    value_type* allocate(std::size_t n)
-    {
-        if (m_pNext + n <= m_pBuffer + N)
-        {
-            value_type *p = m_pNext;
-            m_pNext += n;
-            return p;
-        }
-        throw std::bad_alloc();
-    }
-
-    void deallocate(value_type* p, std::size_t n) const {}
-
-private:
-    value_type* m_pBuffer = nullptr;
-    value_type* m_pNext = nullptr;
-};
-
-// create a memory arena on the stack of N bytes
-template <std::size_t N>
-class StackArena
-{
-public:
-    using value_type = uint8_t;
-
-    StackArena() {}
-    ~StackArena() {}
-    StackArena(const StackArena&) = delete;
-    StackArena& operator=(const StackArena&) = delete;
-
-    static constexpr std::size_t size() { return N; }
-
-    value_type* allocate(std::size_t n)
-    {
-        if (m_nIndex + n > N)
-        {
-            throw std::bad_alloc();
-        }
-        value_type* pNewBuffer = &m_Buffer[m_nIndex];
-        m_nIndex += n;
-        return pNewBuffer;
-    }
-    void deallocate(value_type* p, std::size_t n) const {}
-
-private:
-    alignas(alignof(std::max_align_t)) value_type m_Buffer[N];
-    std::size_t m_nIndex = 0;
-};
-
-// local allocator of T, maximum N bytes, default to 1KB
-template <class T, std::size_t N = 1024, class Arena = StackArena<N> >
-class LocalAllocator
-{
-public:
-    using value_type = T;
-    static auto constexpr element_size = sizeof(T);
-    using arena_type = Arena;
-
-private:
-    using data_type = typename arena_type::value_type;
-    arena_type& m_Arena;
-
-public:
-    LocalAllocator(const LocalAllocator&) = default;
-    LocalAllocator& operator=(const LocalAllocator&) = delete;
-
-    LocalAllocator(arena_type& a) noexcept : m_Arena(a) {}
-    template <class U>
-    LocalAllocator(const LocalAllocator<U, N, Arena>& a) noexcept : m_Arena(a.m_Arena) {}
-
-    template <typename U> struct rebind { typedef LocalAllocator<U, N, Arena> other; };
-
-    value_type* allocate(std::size_t n) { return reinterpret_cast<value_type*>(m_Arena.allocate(n * element_size)); }
-
-    void deallocate(value_type* p, std::size_t n) { m_Arena.deallocate(reinterpret_cast<data_type*>(p), n * element_size); }
-
-    template <class T1, std::size_t N1, class A1, class T2, std::size_t N2, class A2>
-    friend bool operator==(const LocalAllocator<T1, N1, A2>& x, const LocalAllocator<T2, N2, A2>& y) noexcept;
-
-    template <class T1, std::size_t N1, class A1, class T2, std::size_t N2, class A2>
-    friend bool operator!=(const LocalAllocator<T1, N1, A1>& x, const LocalAllocator<T2, N2, A2>& y) noexcept;
-
-    template<class U, std::size_t M, class A> friend class LocalAllocator;
-};
-
-template <class T1, std::size_t N1, class A1, class T2, std::size_t N2, class A2>
-bool operator==(const LocalAllocator<T1, N1, A1>& x, const LocalAllocator<T2, N2, A2>& y) noexcept
-{
-    return (N1 == N2) && (&x.m_Arena == &y.m_Arena);
-}
-
-template <class T1, std::size_t N1, class A1, class T2, std::size_t N2, class A2>
-bool operator!=(const LocalAllocator<T1, N1, A1>& x, const LocalAllocator<T2, N2, A1>& y) noexcept
-{
-    return !(x == y);
-}
+#include <string>
+#include <vector>
+#include "AllocationCounter.h"
+#include "Arena.h"
+#include "SmallVector.h"
 
 // local memory monotonic allocator of T, maximum N elements
-template <class T, std::size_t N = 100>
+// the arena template defaults to HeapArena, MappedArena suits vectors of hundreds of MB
+// the buffer grows in place in the arena, so the vector can hold all N elements
+template <class T, std::size_t N = 100, template <std::size_t> class ArenaT = HeapArena>
 class MyVector
 {
 public:
     static constexpr std::size_t buffer_size = N * sizeof(T);
 
-    using vector_type = std::vector<T, LocalAllocator<T, buffer_size, HeapArena<buffer_size> > >;
+    using vector_type = SmallVector<T, 0, LocalAllocator<T, buffer_size, ArenaT<buffer_size> > >;
     using value_type = typename vector_type::value_type;
     using size_type = typename vector_type::size_type;
 
@@ -151,6 +41,7 @@ public:
     reference back() { return m_Vector.back(); }
     const_reference back() const { return m_Vector.back(); }
     bool empty() const { return m_Vector.empty(); }
+    size_type size() const { return m_Vector.size(); }
     void push_back(const value_type& val) { m_Vector.push_back(val); }
     void reserve(size_type n) { m_Vector.reserve(n); }
 
@@ -168,11 +59,26 @@ using MyStackMap = std::map<Key, T, std::less<Key>, LocalAllocator<std::pair<con
 template <class T, std::size_t N = 1000>
 using MyStackVector = std::vector<T, LocalAllocator<T, N> >;
 
+// MyStackVector that grows its buffer in place when it is the last allocation in the arena
+template <class T, std::size_t N = 1000>
+using MyGrowableStackVector = SmallVector<T, 0, LocalAllocator<T, N> >;
+
 template <std::size_t N = 1000>
 using MyStackString = std::basic_string<char, std::char_traits<char>, LocalAllocator<char, N> >;
 
-using MyScopedString = std::basic_string<char, std::char_traits<char>, LocalAllocator<char> >;
-using MyScopedVector = std::vector<MyScopedString, std::scoped_allocator_adaptor<LocalAllocator<MyScopedString> > >;
+// Containers that pass their arena down to their elements through std::scoped_allocator_adaptor,
+// so every string and inner container buffer is allocated from the same arena as the outer container
+template <std::size_t N = 1024, class Arena = StackArena<N> >
+using MyArenaString = std::basic_string<char, std::char_traits<char>, LocalAllocator<char, N, Arena> >;
+
+template <class T, std::size_t N = 1024, class Arena = StackArena<N> >
+using MyArenaVector = std::vector<T, std::scoped_allocator_adaptor<LocalAllocator<T, N, Arena> > >;
+
+template <class Key, class T, std::size_t N = 1024, class Arena = StackArena<N> >
+using MyArenaMap = std::map<Key, T, std::less<Key>, std::scoped_allocator_adaptor<LocalAllocator<std::pair<const Key, T>, N, Arena> > >;
+
+using MyScopedString = MyArenaString<>;
+using MyScopedVector = MyArenaVector<MyScopedString>;
 
 
 
@@ -214,25 +120,35 @@ void PrintStringMap(const T& v)
 
 inline void VectorTest()
 {
-    //{
-    //    MyVector<int> mIntVector;
-
-    //    mIntVector.push_back(10);
-    //    mIntVector.push_back(20);
-    //    mIntVector.push_back(30);
-    //    PrintIntVector(mIntVector);
-
-    //    MyStackVector<int>::allocator_type::arena_type aInt;
-    //    MyStackVector<int> mIntStackVector{ aInt };
-
-    //    mIntStackVector.push_back(10);
-    //    mIntStackVector.push_back(20);
-    //    mIntStackVector.push_back(30);
-    //    mIntStackVector.push_back(40);
-    //    mIntStackVector.push_back(50);
-    //    mIntStackVector.push_back(60);
-    //    PrintIntVector(mIntStackVector);
-    //}
+    {
+        MyVector<int> mIntVector;
+
+        mIntVector.push_back(10);
+        mIntVector.push_back(20);
+        mIntVector.push_back(30);
+        PrintIntVector(mIntVector);
+
+        // growth reuses the arena bytes, so all 100 elements fit in the 100 element arena
+        for (int i = 3; i < 100; ++i)
+        {
+            mIntVector.push_back(i);
+        }
+        assert(mIntVector.size() == 100);
+
+        MyStackVector<int>::allocator_type::arena_type aInt;
+        MyStackVector<int> mIntStackVector{ aInt };
+
+        {
+            AllocationCounter::ExpectNoAllocations guard("MyStackVector<int>");
+            mIntStackVector.push_back(10);
+            mIntStackVector.push_back(20);
+            mIntStackVector.push_back(30);
+            mIntStackVector.push_back(40);
+            mIntStackVector.push_back(50);
+            mIntStackVector.push_back(60);
+        }
+        PrintIntVector(mIntStackVector);
+    }
 
     {
         MyStackString<>::allocator_type::arena_type aStringArena;
@@ -240,29 +156,87 @@ inline void VectorTest()
         mString = "This is a test of StackString";
         mString = "A second test of the StackString class template";
 
-        MyStackVector<MyStackString<> >::allocator_type::arena_type aString;
-        MyStackVector<MyStackString<> > mStringVector{ aString };
+        // the scoped allocator constructs each string with the vector's arena
+        MyArenaVector<MyArenaString<1000>, 1000>::allocator_type::outer_allocator_type::arena_type aString;
+        MyArenaVector<MyArenaString<1000>, 1000> mStringVector{ aString };
 
-        //mStringVector.push_back("hello");
-        //mStringVector.push_back("there");
-        //mStringVector.push_back("world");
-        //mStringVector.push_back("hello  there  world!");
-        //mStringVector.push_back("long string number two");
-        //mStringVector.push_back("and this is the end");
-        //PrintStringVector(mStringVector);
+        {
+            AllocationCounter::ExpectNoAllocations guard("MyArenaVector<MyArenaString>");
+            mStringVector.emplace_back("hello");
+            mStringVector.emplace_back("there");
+            mStringVector.emplace_back("world");
+            mStringVector.emplace_back("hello  there  world!");
+            mStringVector.emplace_back("long string number two");
+            mStringVector.emplace_back("and this is the end");
+        }
+        PrintStringVector(mStringVector);
     }
 
-    //{
-    //    LocalAllocator<char, 1000>::arena_type scopedArena;
-    //    LocalAllocator<char, 1000> scopedAllocator{ scopedArena };
-    //    MyScopedVector v{ scopedAllocator };
-
-    //    MyScopedString mScopedString{ scopedAllocator };
-    //}
+    {
+        MyScopedVector::allocator_type::outer_allocator_type::arena_type scopedArena;
+        MyScopedVector::allocator_type scopedAllocator{ scopedArena };
+        MyScopedVector v{ scopedAllocator };
+
+        MyScopedString mScopedString{ scopedAllocator };
+        mScopedString = "a string long enough to need its own buffer";
+        v.push_back(mScopedString);
+        assert(scopedArena.owns(v.back().data()));
+    }
 
     Mercury::Trace("Vector test done\n");
 }
 
+// Nested containers on one arena, every inner buffer must come from the arena rather than the heap
+inline void ScopedAllocatorTest()
+{
+    constexpr std::size_t N = 16 * 1024;
+    using Arena = StackArena<N>;
+    using String = MyArenaString<N, Arena>;
+
+    Arena a;
+    AllocationCounter::ExpectNoAllocations guard("ScopedAllocatorTest");
+
+    {
+        MyArenaVector<String, N, Arena> v{ a };
+        for (int i = 0; i < 20; ++i)
+        {
+            v.emplace_back("a string that is too long for the small string buffer");
+        }
+        v.emplace_back(v.front());
+        for (const auto& s : v)
+        {
+            assert(a.owns(s.data()));
+            assert(s.get_allocator().arena().owns(s.data()));
+        }
+    }
+
+    {
+        using IntVector = MyArenaVector<int, N, Arena>;
+        MyArenaMap<String, IntVector, N, Arena> m{ a };
+
+        m.emplace(std::piecewise_construct, std::forward_as_tuple("first key, long enough to allocate"), std::forward_as_tuple());
+        m.emplace(std::piecewise_construct, std::forward_as_tuple("second key, long enough to allocate"), std::forward_as_tuple());
+        for (auto& entry : m)
+        {
+            for (int i = 0; i < 100; ++i)
+            {
+                entry.second.push_back(i);
+            }
+        }
+
+        // copies are constructed with the arena of the map, not a default allocator
+        auto copy = m;
+        for (const auto& entry : copy)
+        {
+            assert(a.owns(entry.first.data()));
+            assert(a.owns(entry.second.data()));
+            assert(entry.second.size() == 100);
+        }
+    }
+
+    assert(a.stats().failed_allocations == 0);
+}
+
 template <class Map, class Key, class Value>
 void insert(Map& m_Map, Key key, Value value)
 {
@@ -273,9 +247,12 @@ inline void MapTest()
 {
     MyStackMap<int, int>::allocator_type::arena_type a;
     MyStackMap<int, int> mIntMap{ a };
-    insert(mIntMap, 5, 10);
-    insert(mIntMap, 15, 20);
-    insert(mIntMap, 25, 30);
+    {
+        AllocationCounter::ExpectNoAllocations guard("MyStackMap<int, int>");
+        insert(mIntMap, 5, 10);
+        insert(mIntMap, 15, 20);
+        insert(mIntMap, 25, 30);
+    }
     PrintIntMap(mIntMap);
 
     MyStackMap<std::string, std::string> mStringMap{ a };
@@ -284,3 +261,64 @@ inline void MapTest()
 
     Mercury::Trace("Done\n");
 }
+
+inline void ArenaStatsTest()
+{
+    MyStackVector<int>::allocator_type::arena_type a;
+    MyStackVector<int> v{ a };
+    for (int i = 0; i < 10; ++i)
+    {
+        v.push_back(i);
+    }
+
+#if ARENA_STATS
+    // every buffer abandoned by the vector growth stays in the arena
+    assert(a.stats().allocations == a.stats().deallocations + 1);
+    assert(a.stats().failed_allocations == 0);
+    assert(a.stats().high_water_mark == a.used());
+#endif
+
+    TraceArenaStats("MyStackVector<int>", a);
+
+    MyGrowableStackVector<int>::allocator_type::arena_type b;
+    MyGrowableStackVector<int> g{ b };
+    for (int i = 0; i < 250; ++i)
+    {
+        g.push_back(i);
+    }
+
+    // a single buffer grown in place, no bytes lost to abandoned buffers
+    assert(b.used() == g.capacity() * sizeof(int));
+#if ARENA_STATS
+    assert(b.stats().allocations == 1);
+    assert(b.stats().expansions > 0);
+#endif
+
+    TraceArenaStats("MyGrowableStackVector<int>", b);
+}
+
+// A node container on a pool reuses the blocks of erased nodes instead of bumping through the arena
+inline void PoolTest()
+{
+    using Pool = HeapPool<16 * 1024>;
+    using Alloc = LocalAllocator<std::pair<const int, int>, 16 * 1024, Pool>;
+
+    Pool p;
+    std::map<int, int, std::less<int>, Alloc> m{ Alloc(p) };
+    for (int i = 0; i < 100; ++i)
+    {
+        m.emplace(i, i);
+    }
+    const std::size_t used = p.used();
+
+    AllocationCounter::ExpectNoAllocations guard("PoolTest");
+    for (int round = 0; round < 10; ++round)
+    {
+        m.clear();
+        for (int i = 0; i < 100; ++i)
+        {
+            m.emplace(i, round);
+        }
+    }
+    assert(p.used() == used);
+}
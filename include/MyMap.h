@@ -1,90 +1,37 @@
 #pragma once
 
+#include <cassert>
+#include <cstddef>
 #include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
 #include <vector>
+#include "MyAlloc.h"
 
-template <class T, int N>
-class Arena
+// buffer shared by a MonotonicAllocator and its copies and rebinds, the arena is created on first use
+// It is not nested in the allocator, so that allocators of different T share the one type
+struct MonotonicPool
 {
-public:
-    using value_type = T;
-
-    value_type* allocate(std::size_t n)
-    {
-        value_type* pNewBuffer = &m_Buffer[m_nIndex];
-        m_nIndex += n;
-        return pNewBuffer;
-    }
-    void deallocate(value_type* p, std::size_t n) {}
-
-private:
-    value_type m_Buffer[N];
-    std::size_t m_nIndex = 0;
+    std::optional<BasicArena<DynamicHeapStorage> > m_Arena;
 };
 
+// monotonic allocator of T, maximum N elements
+// The buffer is shared by every copy and rebind of the allocator and freed with the last of them. It is
+// sized on the first allocation, by the type that allocates, so a map gets room for N nodes rather than
+// N pairs. A copied container gets a buffer of its own, a moved or swapped container takes its buffer along
 template <class T, std::size_t N>
-class LocalAllocator
-{
-public:
-    using value_type = T;
-    using arena_type = Arena<T, N>;
-
-private:
-    arena_type& m_Arena;
-
-public:
-    LocalAllocator(const LocalAllocator&) = default;
-    LocalAllocator& operator=(const LocalAllocator&) = delete;
-
-    LocalAllocator(arena_type& a) noexcept : m_Arena(a) {}
-    template <class U>
-    LocalAllocator(const LocalAllocator<U, N>& a) noexcept : m_Arena(a.m_Arena) {}
-
-    template <typename U> struct rebind { typedef LocalAllocator<U, N> other; };
-
-    value_type* allocate(std::size_t n) { return m_Arena.allocate(n); }
-
-    void deallocate(value_type* p, std::size_t n) { m_Arena.deallocate(p, n); }
-
-    template <class T1, std::size_t N1, class T2, std::size_t N2>
-    friend bool operator==(const LocalAllocator<T1, N1>& x, const LocalAllocator<T2, N2>& y) noexcept;
-
-    template <class T1, std::size_t N1, class T2, std::size_t N2>
-    friend bool operator!=(const LocalAllocator<T1, N1>& x, const LocalAllocator<T2, N2>& y) noexcept;
-
-    template<class U, std::size_t M> friend class LocalAllocator;
-};
-
-template <class T1, std::size_t N1, class T2, std::size_t N2>
-bool operator==(const LocalAllocator<T1, N1>& x, const LocalAllocator<T2, N2>& y) noexcept
-{
-    return (N1 == N2) && (&x.m_Arena == &y.m_Arena);
-}
-
-template <class T1, std::size_t N1, class T2, std::size_t N2>
-bool operator!=(const LocalAllocator<T1, N1>& x, const LocalAllocator<T2, N2>& y) noexcept
-{
-    return !(x == y);
-}
-
-//template <class Key, class T, int N = 100>
-//using MyStackMap = std::map<Key, T, std::less<Key>, StackAllocator<std::pair<const Key, T>, N> >;
-
-template <class T, int N = 100>
-using MyStackVector = std::vector<T, LocalAllocator<T, N> >;
-
-inline void xxx()
-{
-    MyStackVector<int>::allocator_type::arena_type a;
-    MyStackVector<int> v{a};
-}
-#define BUFFER 1
-
-template <class T, int N>
 class MonotonicAllocator
 {
+    using arena_type = BasicArena<DynamicHeapStorage>;
+    using Pool = MonotonicPool;
+
 public:
     using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
 
     template <typename U>
     struct rebind
@@ -92,141 +39,105 @@ public:
         typedef MonotonicAllocator<U, N> other;
     };
 
-    MonotonicAllocator() noexcept {}
-
-    template <class U>
-    explicit MonotonicAllocator(const MonotonicAllocator<U, N>& alloc) noexcept
+    MonotonicAllocator()
+        : m_pPool(std::make_shared<Pool>())
     {
     }
 
-    ~MonotonicAllocator() noexcept
-    {
-#if BUFFER
-        if (m_pBegin)
-        {
-            ::operator delete(static_cast<void*>(m_pBegin));
-            m_pBegin = nullptr;
-        }
-#endif
-    }
+    // no move constructor, a moved-from allocator must still share the buffer
+    MonotonicAllocator(const MonotonicAllocator&) = default;
+    MonotonicAllocator& operator=(const MonotonicAllocator&) = default;
 
-    void deallocate(value_type* p, std::size_t n)
+    template <class U>
+    MonotonicAllocator(const MonotonicAllocator<U, N>& alloc) noexcept
+        : m_pPool(alloc.m_pPool)
     {
-#if BUFFER
-        if (m_nSize > 0)
-        {
-            if (p < m_pBegin || p >= m_pEnd)
-            {
-                DebugBreak();
-            }
-        }
-#else
-        ::operator delete(static_cast<void*>(p));
-#endif
     }
 
+    MonotonicAllocator select_on_container_copy_construction() const { return MonotonicAllocator(); }
+
     value_type* allocate(std::size_t n)
     {
-#if BUFFER
-        if (m_nCount + n > N)
+        if (!m_pPool->m_Arena)
         {
-            throw std::bad_alloc();
+            m_pPool->m_Arena.emplace(N * sizeof(value_type));
         }
-
-        AllocPool();
-        return AllocBlock(n);
-#else
-        m_nCount += n;
-        return static_cast<value_type*>(::operator new(n * sizeof(value_type)));
-#endif
+        return reinterpret_cast<value_type*>(m_pPool->m_Arena->allocate(n * sizeof(value_type)));
     }
 
-private:
-    void AllocPool()
+    void deallocate(value_type* p, std::size_t n)
     {
-        if (m_pBegin == nullptr)
-        {
-            m_pNext = m_pBegin = static_cast<value_type*>(::operator new(N * sizeof(value_type)));
-            m_pEnd = m_pBegin + N;
-        }
+        assert(m_pPool->m_Arena && m_pPool->m_Arena->owns(p) && "pointer was not allocated from this allocator");
+        m_pPool->m_Arena->deallocate(reinterpret_cast<arena_type::value_type*>(p), n * sizeof(value_type));
     }
 
-    value_type* AllocBlock(std::size_t n)
-    {
-        value_type* retval = m_pNext;
-        m_pNext += n;
-        m_nCount += n;
-        return retval;
-    }
+    // the arena behind the allocator, nullptr before the first allocation
+    const arena_type* arena() const noexcept { return m_pPool->m_Arena ? &*m_pPool->m_Arena : nullptr; }
+
+    template <class T1, class T2, std::size_t M>
+    friend bool operator==(const MonotonicAllocator<T1, M>& x, const MonotonicAllocator<T2, M>& y) noexcept;
 
-    value_type* m_pBegin = nullptr;
-    value_type* m_pEnd = nullptr;
-    value_type* m_pNext = nullptr;
-    std::size_t m_nSize = sizeof(value_type);
-    std::size_t m_nCount = 0;
+    template <class U, std::size_t M> friend class MonotonicAllocator;
+
+private:
+    std::shared_ptr<Pool> m_pPool;
 };
 
-template <class T, class U, int N>
-bool operator==(MonotonicAllocator<T, N> const&, MonotonicAllocator<U, N> const&) noexcept
+template <class T, class U, std::size_t N>
+bool operator==(const MonotonicAllocator<T, N>& x, const MonotonicAllocator<U, N>& y) noexcept
 {
-    return true;
+    return x.m_pPool == y.m_pPool;
 }
 
-template <class T, class U, int N>
-bool operator!=(MonotonicAllocator<T, N> const& x, MonotonicAllocator<U, N> const& y) noexcept
+template <class T, class U, std::size_t N>
+bool operator!=(const MonotonicAllocator<T, N>& x, const MonotonicAllocator<U, N>& y) noexcept
 {
     return !(x == y);
 }
 
-template <class Key, class T, int N = 100>
+template <class Key, class T, std::size_t N = 100>
 using MyMap = std::map<Key, T, std::less<Key>, MonotonicAllocator<std::pair<const Key, T>, N> >;
 
-template <class T, int N = 100>
-using MyVector = std::vector<T, MonotonicAllocator<T, N> >;
+template <class T, std::size_t N = 100>
+using MyMonotonicVector = std::vector<T, MonotonicAllocator<T, N> >;
 
 typedef MyMap<std::string, std::string> stringMap;
 typedef MyMap<int, int> intMap;
 
-template <class Map, class Key, class Value>
-void insert(Map& m_Map, Key key, Value value)
-{
-    m_Map.insert(std::make_pair(key, value));
-}
-
-inline void MapTest()
+inline void MonotonicMapTest()
 {
-    Arena<int, 50> mArena;
-
-    //intMap mIntMap;
-    //insert(mIntMap, 5, 10);
-    //insert(mIntMap, 15, 20);
-    //insert(mIntMap, 25, 30);
-
-    //for (auto& i : mIntMap)
-    //{
-    //    Mercury::Trace("key %d  value %d\n", i.first, i.second);
-    //}
-
-    //MyVector<int> mIntVector;
-    //mIntVector.push_back(10);
-    //mIntVector.push_back(20);
-    //mIntVector.push_back(30);
-
-    //MyVector<int> mCopy(mIntVector);
-    //mCopy.push_back(40);
-
-    //for (auto& i : mCopy)
-    //{
-    //    Mercury::Trace("value %d\n", i);
-    //}
-
-    //stringMap mStringMap;
-    //insert(mStringMap, "hello", "world");
-
-    //for (auto& i : mStringMap)
-    //{
-    //    Mercury::Trace("key %s  value %s\n", i.first.c_str(), i.second.c_str());
-    //}
+    intMap mIntMap;
+    insert(mIntMap, 5, 10);
+    insert(mIntMap, 15, 20);
+    insert(mIntMap, 25, 30);
+    PrintIntMap(mIntMap);
+
+    MyMonotonicVector<int> mIntVector;
+    mIntVector.push_back(10);
+    mIntVector.push_back(20);
+    mIntVector.push_back(30);
+
+    // the copy has a buffer of its own
+    MyMonotonicVector<int> mCopy(mIntVector);
+    mCopy.push_back(40);
+    assert(mCopy.get_allocator() != mIntVector.get_allocator());
+    PrintIntVector(mCopy);
+
+    // the moved vector keeps its buffer
+    MyMonotonicVector<int> mMoved;
+    mMoved = std::move(mCopy);
+    assert(mMoved.size() == 4 && mMoved.get_allocator().arena()->owns(mMoved.data()));
+
+    // a map built from an explicit allocator rebinds it to its node type, and the rebinds share the buffer
+    MonotonicAllocator<int, 100> alloc;
+    intMap mShared(std::less<int>(), alloc);
+    insert(mShared, 1, 2);
+    assert(mShared.get_allocator() == alloc);
+    assert(alloc.arena() != nullptr && alloc.arena() == mShared.get_allocator().arena());
+
+    stringMap mStringMap;
+    insert(mStringMap, "hello", "world");
+    PrintStringMap(mStringMap);
 
     Mercury::Trace("Done\n");
 }
@@ -0,0 +1,379 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "AllocationCounter.h"
+
+// Reference to an object in an ObjectPool, 20 bits of slot index and 12 bits of generation
+// The generation of a slot changes each time its object is destroyed, so a handle kept past the object
+// no longer resolves. A default constructed handle is null and never resolves
+template <class T>
+class PoolHandle
+{
+public:
+    static constexpr unsigned index_bits = 20;
+    static constexpr unsigned generation_bits = 12;
+    static constexpr std::uint32_t max_index = (1u << index_bits) - 1;
+    static constexpr std::uint32_t max_generation = (1u << generation_bits) - 1;
+
+    PoolHandle() noexcept = default;
+    PoolHandle(std::uint32_t index, std::uint32_t generation) noexcept
+        : m_nValue((generation << index_bits) | index)
+    {
+        assert(index <= max_index && generation <= max_generation);
+    }
+
+    std::uint32_t index() const noexcept { return m_nValue & max_index; }
+    std::uint32_t generation() const noexcept { return m_nValue >> index_bits; }
+    std::uint32_t value() const noexcept { return m_nValue; }
+
+    explicit operator bool() const noexcept { return m_nValue != 0; }
+
+    friend bool operator==(PoolHandle x, PoolHandle y) noexcept { return x.m_nValue == y.m_nValue; }
+    friend bool operator!=(PoolHandle x, PoolHandle y) noexcept { return x.m_nValue != y.m_nValue; }
+
+private:
+    std::uint32_t m_nValue = 0;
+};
+
+// Pool of T stored densely in chunks of ChunkSize objects
+// create() and destroy() are O(1), destroy() moves the last object into the hole so the live objects
+// stay contiguous for iteration. Objects therefore move, refer to them by handle rather than by pointer
+// Chunks are allocated as the pool grows and kept until the pool is destroyed, so a pool at steady
+// state does not allocate
+template <class T, std::size_t ChunkSize = 256>
+class ObjectPool
+{
+    static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "chunk size must be a power of two");
+
+    struct Chunk
+    {
+        alignas(T) unsigned char m_Data[ChunkSize * sizeof(T)];
+    };
+
+    struct Slot
+    {
+        std::uint32_t m_nDense;       // position of the object, or the next free slot when the slot is free
+        std::uint32_t m_nGeneration;
+    };
+
+    static constexpr std::uint32_t end_of_list = ~std::uint32_t(0);
+
+public:
+    using value_type = T;
+    using handle_type = PoolHandle<T>;
+    using size_type = std::size_t;
+
+    template <class Value>
+    class basic_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        basic_iterator() noexcept = default;
+        basic_iterator(Chunk* const* ppChunks, std::size_t pos) noexcept
+            : m_ppChunks(ppChunks)
+            , m_nPos(pos)
+        {
+        }
+
+        reference operator*() const noexcept { return *at(m_nPos); }
+        pointer operator->() const noexcept { return at(m_nPos); }
+        reference operator[](difference_type n) const noexcept { return *at(m_nPos + n); }
+
+        basic_iterator& operator++() noexcept { ++m_nPos; return *this; }
+        basic_iterator operator++(int) noexcept { auto tmp = *this; ++m_nPos; return tmp; }
+        basic_iterator& operator--() noexcept { --m_nPos; return *this; }
+        basic_iterator operator--(int) noexcept { auto tmp = *this; --m_nPos; return tmp; }
+        basic_iterator& operator+=(difference_type n) noexcept { m_nPos += n; return *this; }
+        basic_iterator& operator-=(difference_type n) noexcept { m_nPos -= n; return *this; }
+        basic_iterator operator+(difference_type n) const noexcept { return basic_iterator(m_ppChunks, m_nPos + n); }
+        basic_iterator operator-(difference_type n) const noexcept { return basic_iterator(m_ppChunks, m_nPos - n); }
+        difference_type operator-(const basic_iterator& other) const noexcept
+        {
+            return static_cast<difference_type>(m_nPos) - static_cast<difference_type>(other.m_nPos);
+        }
+
+        bool operator==(const basic_iterator& other) const noexcept { return m_nPos == other.m_nPos; }
+        bool operator!=(const basic_iterator& other) const noexcept { return m_nPos != other.m_nPos; }
+        bool operator<(const basic_iterator& other) const noexcept { return m_nPos < other.m_nPos; }
+        bool operator>(const basic_iterator& other) const noexcept { return m_nPos > other.m_nPos; }
+        bool operator<=(const basic_iterator& other) const noexcept { return m_nPos <= other.m_nPos; }
+        bool operator>=(const basic_iterator& other) const noexcept { return m_nPos >= other.m_nPos; }
+
+    private:
+        pointer at(std::size_t pos) const noexcept
+        {
+            return reinterpret_cast<pointer>(m_ppChunks[pos / ChunkSize]->m_Data) + pos % ChunkSize;
+        }
+
+        Chunk* const* m_ppChunks = nullptr;
+        std::size_t m_nPos = 0;
+    };
+
+    using iterator = basic_iterator<T>;
+    using const_iterator = basic_iterator<const T>;
+
+    ObjectPool() {}
+    ~ObjectPool() { clear(); }
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    static constexpr size_type max_size() { return handle_type::max_index; }
+    size_type size() const noexcept { return m_Dense.size(); }
+    size_type capacity() const noexcept { return m_Chunks.size() * ChunkSize; }
+    bool empty() const noexcept { return m_Dense.empty(); }
+
+    // Allocate chunks and slots for at least n objects
+    void reserve(size_type n)
+    {
+        if (n > max_size())
+        {
+            throw std::length_error("ObjectPool::reserve");
+        }
+        while (capacity() < n)
+        {
+            add_chunk();
+        }
+        m_Slots.reserve(n);
+        m_Dense.reserve(n);
+    }
+
+    template <class... Args>
+    handle_type create(Args&&... args)
+    {
+        const size_type pos = size();
+        if (pos == max_size())
+        {
+            throw std::length_error("ObjectPool::create");
+        }
+        // the slots and the dense array grow geometrically, only an explicit reserve() sizes them exactly
+        if (pos == capacity())
+        {
+            add_chunk();
+        }
+
+        // reuse the most recently freed slot, or add one
+        std::uint32_t index;
+        if (m_nFreeList != end_of_list)
+        {
+            index = m_nFreeList;
+            m_nFreeList = m_Slots[index].m_nDense;
+        }
+        else
+        {
+            index = static_cast<std::uint32_t>(m_Slots.size());
+            m_Slots.push_back(Slot{ 0, 1 });
+        }
+
+        try
+        {
+            m_Dense.push_back(index);
+            ::new (static_cast<void*>(at(pos))) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            if (m_Dense.size() != pos)
+            {
+                m_Dense.pop_back();
+            }
+            m_Slots[index].m_nDense = m_nFreeList;
+            m_nFreeList = index;
+            throw;
+        }
+
+        m_Slots[index].m_nDense = static_cast<std::uint32_t>(pos);
+        return handle_type(index, m_Slots[index].m_nGeneration);
+    }
+
+    // Destroy the object of h, returns false when h is stale
+    bool destroy(handle_type h)
+    {
+        if (!valid(h))
+        {
+            return false;
+        }
+
+        Slot& slot = m_Slots[h.index()];
+        const std::uint32_t pos = slot.m_nDense;
+        const std::uint32_t last = static_cast<std::uint32_t>(size() - 1);
+
+        // fill the hole with the last object to keep the objects dense
+        if (pos != last)
+        {
+            *at(pos) = std::move(*at(last));
+            m_Dense[pos] = m_Dense[last];
+            m_Slots[m_Dense[pos]].m_nDense = pos;
+        }
+        at(last)->~T();
+        m_Dense.pop_back();
+
+        // a new generation makes every existing handle to the slot stale, generation 0 is reserved for the null handle
+        slot.m_nGeneration = slot.m_nGeneration == handle_type::max_generation ? 1 : slot.m_nGeneration + 1;
+        slot.m_nDense = m_nFreeList;
+        m_nFreeList = h.index();
+        return true;
+    }
+
+    bool valid(handle_type h) const noexcept
+    {
+        if (!h || h.index() >= m_Slots.size())
+        {
+            return false;
+        }
+        // the dense check rejects a free slot whose generation has wrapped around to the handle's
+        const Slot& slot = m_Slots[h.index()];
+        return slot.m_nGeneration == h.generation() && slot.m_nDense < size() && m_Dense[slot.m_nDense] == h.index();
+    }
+
+    // The object of h, nullptr when h is stale
+    T* get(handle_type h) noexcept { return valid(h) ? at(m_Slots[h.index()].m_nDense) : nullptr; }
+    const T* get(handle_type h) const noexcept { return valid(h) ? at(m_Slots[h.index()].m_nDense) : nullptr; }
+
+    // Handle of the object at position pos of the iteration order
+    handle_type handle_at(size_type pos) const noexcept
+    {
+        const std::uint32_t index = m_Dense[pos];
+        return handle_type(index, m_Slots[index].m_nGeneration);
+    }
+
+    // Destroy every object, chunks and slots are kept and every outstanding handle becomes stale
+    void clear() noexcept
+    {
+        while (!empty())
+        {
+            destroy(handle_at(size() - 1));
+        }
+    }
+
+    iterator begin() noexcept { return iterator(m_ChunkPointers.data(), 0); }
+    iterator end() noexcept { return iterator(m_ChunkPointers.data(), size()); }
+    const_iterator begin() const noexcept { return const_iterator(m_ChunkPointers.data(), 0); }
+    const_iterator end() const noexcept { return const_iterator(m_ChunkPointers.data(), size()); }
+
+    // Call fn on every live object, a chunk at a time
+    template <class Fn>
+    void for_each(Fn fn)
+    {
+        for (size_type first = 0; first < size(); first += ChunkSize)
+        {
+            T* p = at(first);
+            const size_type count = size() - first < ChunkSize ? size() - first : ChunkSize;
+            for (size_type i = 0; i < count; ++i)
+            {
+                fn(p[i]);
+            }
+        }
+    }
+
+private:
+    void add_chunk()
+    {
+        m_Chunks.push_back(std::make_unique<Chunk>());
+        m_ChunkPointers.push_back(m_Chunks.back().get());
+    }
+
+    T* at(size_type pos) const noexcept { return reinterpret_cast<T*>(m_ChunkPointers[pos / ChunkSize]->m_Data) + pos % ChunkSize; }
+
+    std::vector<std::unique_ptr<Chunk> > m_Chunks;
+    std::vector<Chunk*> m_ChunkPointers;
+    std::vector<Slot> m_Slots;
+    std::vector<std::uint32_t> m_Dense;  // slot index of the object at each position
+    std::uint32_t m_nFreeList = end_of_list;
+};
+
+inline void ObjectPoolTest()
+{
+    struct Session
+    {
+        Session(int id, const std::string& name)
+            : m_nId(id)
+            , m_sName(name)
+        {
+        }
+
+        int m_nId;
+        std::string m_sName;
+    };
+
+    ObjectPool<Session, 16> pool;
+    std::vector<PoolHandle<Session> > handles;
+
+    for (int i = 0; i < 40; ++i)
+    {
+        handles.push_back(pool.create(i, "session name long enough to allocate " + std::to_string(i)));
+    }
+    assert(pool.size() == 40 && pool.capacity() == 48);
+
+    // destroy the even sessions, the rest stay reachable through their handles after being moved
+    for (int i = 0; i < 40; i += 2)
+    {
+        assert(pool.destroy(handles[i]));
+    }
+    assert(pool.size() == 20);
+    for (int i = 0; i < 40; ++i)
+    {
+        Session* p = pool.get(handles[i]);
+        assert((i % 2 == 0) == (p == nullptr));
+        assert(p == nullptr || p->m_nId == i);
+    }
+
+    // stale handles are detected when the slot is reused
+    PoolHandle<Session> stale = handles[0];
+    auto reused = pool.create(100, "reused");
+    assert(reused.index() == handles[38].index());
+    assert(!pool.valid(stale) && !pool.destroy(stale));
+    assert(pool.get(reused)->m_nId == 100);
+    assert(!pool.valid(PoolHandle<Session>()));
+
+    int sum = 0;
+    for (const Session& s : pool)
+    {
+        sum += s.m_nId;
+    }
+    int sum2 = 0;
+    pool.for_each([&sum2](Session& s) { sum2 += s.m_nId; });
+    assert(sum == sum2 && sum == 400 + 100);
+
+    {
+        // a pool at steady state reuses its chunks and slots
+        ObjectPool<int> ints;
+        ints.reserve(1000);
+        AllocationCounter::ExpectNoAllocations guard("ObjectPool<int>");
+        for (int round = 0; round < 10; ++round)
+        {
+            for (int i = 0; i < 1000; ++i)
+            {
+                ints.create(i);
+            }
+            ints.clear();
+        }
+    }
+
+    {
+        // a growing pool allocates its chunks, the slots and the dense array only grow geometrically
+        ObjectPool<int, 16> ints;
+        AllocationCounter::ScopedCount count;
+        for (int i = 0; i < 4096; ++i)
+        {
+            ints.create(i);
+        }
+        assert(ints.capacity() == 4096);
+        assert(!AllocationCounter::Installed() || count.allocations() < 2 * 4096 / 16);
+    }
+
+    pool.clear();
+    assert(pool.empty() && !pool.valid(reused));
+}
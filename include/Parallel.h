@@ -0,0 +1,210 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Fusion.h"
+#include "ThreadPool.h"
+
+// Parallel evaluation of adaptor pipelines
+// to_vector(par, v | filter(p) | transform(f)) cuts the random-access source into chunks and runs the fused
+// pipeline of each chunk on ThreadPool::instance(). Every chunk collects into a buffer of its own, a prefix
+// sum over the buffer sizes gives each chunk its offset in the result and the buffers are moved there in
+// parallel, so the elements come out in source order. Pipelines that are not splittable, a take anywhere,
+// a source that is not random access or a sentinel end, run sequentially
+// The functions of the pipeline are copied per chunk and called from several threads at once
+
+// clang-format off
+namespace Range
+{
+// clang-format on
+
+struct parallel_policy
+{
+};
+
+constexpr parallel_policy par{};
+
+namespace detail {
+
+// smallest chunk worth the cost of handing it to another thread
+constexpr std::size_t parallel_min_chunk = 4096;
+
+// the source must be cut by position, which a sentinel end does not give
+template <typename Rng>
+struct parallel_splittable
+    : std::integral_constant<bool, fusion_traits<range_iterator_t<Rng> >::splittable &&
+                                       std::is_same<range_iterator_t<Rng>, std::decay_t<decltype(std::declval<const Rng&>().end())> >::value>
+{
+};
+
+// Number of chunks the source of range is cut into, at most four per thread of the pool
+template <typename Rng>
+std::size_t parallel_chunk_count(const Rng& range)
+{
+    using traits = fusion_traits<range_iterator_t<Rng> >;
+
+    const std::size_t size = static_cast<std::size_t>(traits::source_end(range.end()) - traits::source(range.begin()));
+    return std::max<std::size_t>(1, std::min(size / parallel_min_chunk, ThreadPool::instance().concurrency() * 4));
+}
+
+// Call fn(chunk, run) for every chunk of the source of range, in parallel
+// run(sink) runs the pipeline over the chunk's slice of the source
+template <typename Rng, typename Function>
+void parallel_chunks(const Rng& range, std::size_t chunks, Function fn)
+{
+    using traits = fusion_traits<range_iterator_t<Rng> >;
+
+    const auto pipeline = range.begin();
+    const auto first = traits::source(pipeline);
+    const std::size_t size = static_cast<std::size_t>(traits::source_end(range.end()) - first);
+    const std::size_t step = size / chunks;
+    const std::size_t extra = size % chunks;
+
+    ThreadPool::instance().parallel_for(chunks, [&](std::size_t chunk) {
+        // the first extra chunks take one element more
+        const std::size_t begin = chunk * step + std::min(chunk, extra);
+        const std::size_t end = begin + step + (chunk < extra ? 1 : 0);
+        fn(chunk, [&](auto& sink) { traits::run_source(pipeline, first + begin, first + end, sink); });
+    });
+}
+
+}  // namespace detail
+
+// Copy the elements of the range into a vector, in order, evaluating chunks of the range in parallel
+template <typename Rng>
+std::vector<detail::range_value_t<Rng> > to_vector(parallel_policy, const Rng& range)
+{
+    using value_type = detail::range_value_t<Rng>;
+
+    if constexpr (!detail::parallel_splittable<Rng>::value)
+    {
+        return Range::to_vector(range);
+    }
+    else
+    {
+        const std::size_t chunks = detail::parallel_chunk_count(range);
+        std::vector<std::vector<value_type> > buffers(chunks);
+        detail::parallel_chunks(range, chunks, [&buffers](std::size_t chunk, auto run) {
+            std::vector<value_type>& buffer = buffers[chunk];
+            auto sink = [&buffer](auto&& value) {
+                buffer.push_back(std::forward<decltype(value)>(value));
+                return true;
+            };
+            run(sink);
+        });
+
+        // exclusive prefix sum of the chunk sizes
+        std::vector<std::size_t> offsets(chunks + 1, 0);
+        for (std::size_t i = 0; i < chunks; ++i)
+        {
+            offsets[i + 1] = offsets[i] + buffers[i].size();
+        }
+
+        // a value type without a default constructor cannot be moved into place in parallel, it is appended
+        std::vector<value_type> result;
+        if constexpr (std::is_default_constructible<value_type>::value)
+        {
+            result.resize(offsets[chunks]);
+            ThreadPool::instance().parallel_for(chunks, [&](std::size_t chunk) {
+                std::move(buffers[chunk].begin(), buffers[chunk].end(), result.begin() + offsets[chunk]);
+            });
+        }
+        else
+        {
+            result.reserve(offsets[chunks]);
+            for (std::vector<value_type>& buffer : buffers)
+            {
+                result.insert(result.end(), std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()));
+            }
+        }
+        return result;
+    }
+}
+
+namespace detail {
+
+// Each chunk is folded from its first element and the chunk results are folded into init in source order
+template <typename Rng, typename T, typename BinaryOperation>
+T parallel_reduce(const Rng& range, T init, BinaryOperation op)
+{
+    if constexpr (!detail::parallel_splittable<Rng>::value)
+    {
+        return Range::reduce(range, std::move(init), op);
+    }
+    else
+    {
+        const std::size_t chunks = detail::parallel_chunk_count(range);
+        std::vector<std::optional<T> > partials(chunks);
+        detail::parallel_chunks(range, chunks, [&partials, &op](std::size_t chunk, auto run) {
+            std::optional<T> partial;
+            BinaryOperation chunkOp = op;
+            auto sink = [&partial, &chunkOp](auto&& value) {
+                if (partial)
+                {
+                    partial = chunkOp(std::move(*partial), std::forward<decltype(value)>(value));
+                }
+                else
+                {
+                    partial.emplace(std::forward<decltype(value)>(value));
+                }
+                return true;
+            };
+            run(sink);
+            partials[chunk] = std::move(partial);
+        });
+
+        for (std::size_t i = 0; i < chunks; ++i)
+        {
+            if (partials[i])
+            {
+                init = op(std::move(init), std::move(*partials[i]));
+            }
+        }
+        return init;
+    }
+}
+
+}  // namespace detail
+
+// Fold the elements of the range into init, evaluating chunks of the range in parallel
+// op must be associative, and since a chunk starts from its first element instead of init the elements must
+// be of type T. A fold into another type, such as counting elements, transforms them first:
+// reduce(par, range | transform(f), init, op)
+template <typename Rng, typename T, typename BinaryOperation>
+T reduce(parallel_policy, const Rng& range, T init, BinaryOperation op)
+{
+    static_assert(std::is_same<std::decay_t<detail::range_value_t<Rng> >, T>::value, "reduce(par) requires elements of the type of init");
+    static_assert(std::is_invocable_r<T, BinaryOperation&, T, T>::value, "reduce(par) requires op(T, T)");
+    return detail::parallel_reduce(range, std::move(init), op);
+}
+
+// Sum the elements of the range into init, evaluating chunks of the range in parallel
+// Elements of another arithmetic type are added as they are by the sequential reduce
+template <typename Rng, typename T>
+T reduce(parallel_policy, const Rng& range, T init)
+{
+    return detail::parallel_reduce(range, std::move(init), std::plus<>());
+}
+
+// clang-format off
+class parallel_to_vector_holder
+{
+};
+// clang-format on
+
+// Construct the parallel to_vector adaptor, range | to_vector(par)
+inline parallel_to_vector_holder to_vector(parallel_policy)
+{
+    return parallel_to_vector_holder();
+}
+
+template <typename Rng>
+auto operator|(const Rng& range, parallel_to_vector_holder) -> decltype(to_vector(par, range))
+{
+    return to_vector(par, range);
+}
+
+}  // namespace Range
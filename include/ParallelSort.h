@@ -0,0 +1,305 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "ThreadPool.h"
+
+// Sorts of a random-access range on a ThreadPool, ThreadPool::instance() unless one is given
+// parallel_sort cuts the range into one run per thread of the pool, sorts the runs with std::sort and merges
+// them in pairs until one run is left. Each merge is split into pieces along its merge path, so the last
+// merge keeps every thread busy like the first. It is not stable, like std::sort
+// radix_sort is an LSD radix sort for integral and floating-point elements, one byte of the key per pass.
+// Each pass counts the digits of one block per thread, a prefix sum over the counts gives every block the
+// position of each of its digits in the output and the blocks scatter in parallel. A pass whose digit is the
+// same for every element is skipped, so small keys in a wide type cost fewer passes
+// Floating-point elements sort by value, -0.0 before 0.0, and NaNs by their bits: after the positive values
+// when the sign bit is clear, before the negative ones when it is set
+// Both move the elements through a buffer of the range's size, which must be default constructible, and
+// sort ranges below parallel_sort_min elements with std::sort on the calling thread
+
+// clang-format off
+namespace Range
+{
+// clang-format on
+
+namespace detail {
+
+// smallest range, and smallest block of a radix pass, worth the cost of sorting in parallel
+constexpr std::size_t parallel_sort_min = 32 * 1024;
+
+// Number of elements of [a, a + na) among the first d elements of its stable merge with [b, b + nb)
+template <typename Iterator, typename Compare>
+std::size_t merge_path(Iterator a, std::size_t na, Iterator b, std::size_t nb, std::size_t d, Compare& comp)
+{
+    std::size_t lo = d > nb ? d - nb : 0;
+    std::size_t hi = std::min(d, na);
+    while (lo < hi)
+    {
+        // a[i] is among the first d unless b[d - i - 1], which the first d would have to skip, sorts before it
+        const std::size_t i = lo + (hi - lo) / 2;
+        if (comp(b[d - i - 1], a[i]))
+        {
+            hi = i;
+        }
+        else
+        {
+            lo = i + 1;
+        }
+    }
+    return lo;
+}
+
+// Merge the sorted runs of [src, src + size), run elements each, in pairs into dst
+template <typename Source, typename Destination, typename Compare>
+void merge_runs(ThreadPool& pool, Source src, Destination dst, std::size_t size, std::size_t run, const Compare& comp)
+{
+    const std::size_t pairs = (size + 2 * run - 1) / (2 * run);
+    const std::size_t pieces = (pool.concurrency() + pairs - 1) / pairs;
+
+    pool.parallel_for(pairs * pieces, [&](std::size_t job) {
+        const std::size_t first = job / pieces * 2 * run;
+        const std::size_t piece = job % pieces;
+        const std::size_t mid = std::min(first + run, size);
+        const std::size_t last = std::min(first + 2 * run, size);
+        const std::size_t na = mid - first;
+        const std::size_t nb = last - mid;
+
+        // the piece writes [d0, d1) of the merged pair
+        Compare pieceComp = comp;
+        const std::size_t d0 = (last - first) * piece / pieces;
+        const std::size_t d1 = (last - first) * (piece + 1) / pieces;
+        const std::size_t i0 = merge_path(src + first, na, src + mid, nb, d0, pieceComp);
+        const std::size_t i1 = merge_path(src + first, na, src + mid, nb, d1, pieceComp);
+        std::merge(std::make_move_iterator(src + first + i0), std::make_move_iterator(src + first + i1),
+                   std::make_move_iterator(src + mid + (d0 - i0)), std::make_move_iterator(src + mid + (d1 - i1)), dst + first + d0, pieceComp);
+    });
+}
+
+// Move [src, src + size) to dst, a block per thread
+template <typename Source, typename Destination>
+void parallel_move(ThreadPool& pool, Source src, Destination dst, std::size_t size)
+{
+    const std::size_t blocks = pool.concurrency();
+    pool.parallel_for(blocks, [&](std::size_t block) {
+        const std::size_t begin = size * block / blocks;
+        const std::size_t end = size * (block + 1) / blocks;
+        std::move(src + begin, src + end, dst + begin);
+    });
+}
+
+template <std::size_t Size>
+struct radix_unsigned;
+
+template <>
+struct radix_unsigned<1>
+{
+    using type = std::uint8_t;
+};
+
+template <>
+struct radix_unsigned<2>
+{
+    using type = std::uint16_t;
+};
+
+template <>
+struct radix_unsigned<4>
+{
+    using type = std::uint32_t;
+};
+
+template <>
+struct radix_unsigned<8>
+{
+    using type = std::uint64_t;
+};
+
+template <typename T>
+struct is_radix_sortable
+    : std::integral_constant<bool, (std::is_integral<T>::value && !std::is_same<T, bool>::value) ||
+                                       (std::is_floating_point<T>::value && std::numeric_limits<T>::is_iec559 && (sizeof(T) == 4 || sizeof(T) == 8))>
+{
+};
+
+// Unsigned key of value, ordered as the values are
+template <typename T>
+typename radix_unsigned<sizeof(T)>::type radix_key(T value)
+{
+    using key_type = typename radix_unsigned<sizeof(T)>::type;
+    constexpr key_type sign = static_cast<key_type>(key_type(1) << (sizeof(T) * 8 - 1));
+
+    key_type bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        // negative values sort in reverse order of their magnitude, below every positive value
+        return (bits & sign) ? static_cast<key_type>(~bits) : static_cast<key_type>(bits | sign);
+    }
+    else if constexpr (std::is_signed<T>::value)
+    {
+        return static_cast<key_type>(bits ^ sign);
+    }
+    else
+    {
+        return bits;
+    }
+}
+
+using radix_counts = std::array<std::size_t, 256>;
+
+// One pass of radix_sort, scatter [src, src + size) into dst by the byte of the key at shift
+// Returns false without writing dst when every element has the same digit
+template <typename Source, typename Destination>
+bool radix_pass(ThreadPool& pool, Source src, Destination dst, std::size_t size, unsigned shift, std::vector<radix_counts>& counts)
+{
+    const std::size_t blocks = counts.size();
+    auto digit = [shift](const auto& value) { return static_cast<std::size_t>((radix_key(value) >> shift) & 0xff); };
+
+    pool.parallel_for(blocks, [&](std::size_t block) {
+        radix_counts& count = counts[block];
+        count.fill(0);
+        const std::size_t end = size * (block + 1) / blocks;
+        for (std::size_t i = size * block / blocks; i < end; ++i)
+        {
+            ++count[digit(src[i])];
+        }
+    });
+
+    radix_counts total{};
+    for (const radix_counts& count : counts)
+    {
+        for (std::size_t d = 0; d < 256; ++d)
+        {
+            total[d] += count[d];
+        }
+    }
+    if (total[digit(src[0])] == size)
+    {
+        return false;
+    }
+
+    // exclusive prefix sum in digit order, then block order within a digit, which keeps the pass stable
+    std::size_t offset = 0;
+    for (std::size_t d = 0; d < 256; ++d)
+    {
+        for (radix_counts& count : counts)
+        {
+            const std::size_t n = count[d];
+            count[d] = offset;
+            offset += n;
+        }
+    }
+
+    pool.parallel_for(blocks, [&](std::size_t block) {
+        radix_counts& position = counts[block];
+        const std::size_t end = size * (block + 1) / blocks;
+        for (std::size_t i = size * block / blocks; i < end; ++i)
+        {
+            dst[position[digit(src[i])]++] = std::move(src[i]);
+        }
+    });
+    return true;
+}
+
+}  // namespace detail
+
+// Sort [first, last) with comp on the threads of pool
+template <typename RandomIt, typename Compare>
+void parallel_sort(ThreadPool& pool, RandomIt first, RandomIt last, Compare comp)
+{
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    const std::size_t size = static_cast<std::size_t>(last - first);
+    const std::size_t runs = std::min(pool.concurrency(), size / detail::parallel_sort_min);
+    if (runs < 2)
+    {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    std::size_t run = (size + runs - 1) / runs;
+    pool.parallel_for(runs, [&](std::size_t r) {
+        Compare runComp = comp;
+        std::sort(first + std::min(r * run, size), first + std::min((r + 1) * run, size), runComp);
+    });
+
+    // merge back and forth between the range and the buffer, the sorted runs double each time
+    std::vector<value_type> buffer(size);
+    bool inBuffer = false;
+    for (; run < size; run *= 2)
+    {
+        if (inBuffer)
+        {
+            detail::merge_runs(pool, buffer.begin(), first, size, run, comp);
+        }
+        else
+        {
+            detail::merge_runs(pool, first, buffer.begin(), size, run, comp);
+        }
+        inBuffer = !inBuffer;
+    }
+    if (inBuffer)
+    {
+        detail::parallel_move(pool, buffer.begin(), first, size);
+    }
+}
+
+template <typename RandomIt, typename Compare>
+void parallel_sort(RandomIt first, RandomIt last, Compare comp)
+{
+    parallel_sort(ThreadPool::instance(), first, last, comp);
+}
+
+template <typename RandomIt>
+void parallel_sort(RandomIt first, RandomIt last)
+{
+    parallel_sort(ThreadPool::instance(), first, last, std::less<>());
+}
+
+// Sort the integral or floating-point elements of [first, last) in ascending order on the threads of pool
+template <typename RandomIt>
+void radix_sort(ThreadPool& pool, RandomIt first, RandomIt last)
+{
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+    static_assert(detail::is_radix_sortable<value_type>::value, "radix_sort sorts integral and floating-point elements");
+
+    const std::size_t size = static_cast<std::size_t>(last - first);
+    if (size < detail::parallel_sort_min)
+    {
+        std::sort(first, last);
+        return;
+    }
+
+    const std::size_t blocks = std::max<std::size_t>(1, std::min(pool.concurrency(), size / detail::parallel_sort_min));
+    std::vector<detail::radix_counts> counts(blocks);
+    std::vector<value_type> buffer(size);
+    bool inBuffer = false;
+    for (unsigned shift = 0; shift < sizeof(value_type) * 8; shift += 8)
+    {
+        const bool moved = inBuffer ? detail::radix_pass(pool, buffer.begin(), first, size, shift, counts)
+                                    : detail::radix_pass(pool, first, buffer.begin(), size, shift, counts);
+        if (moved)
+        {
+            inBuffer = !inBuffer;
+        }
+    }
+    if (inBuffer)
+    {
+        detail::parallel_move(pool, buffer.begin(), first, size);
+    }
+}
+
+template <typename RandomIt>
+void radix_sort(RandomIt first, RandomIt last)
+{
+    radix_sort(ThreadPool::instance(), first, last);
+}
+
+}  // namespace Range
@@ -2,35 +2,55 @@
 
 #include <algorithm>
 #include <array>
+#include <cassert>
+#include <cstdio>
+#include <deque>
 #include <forward_list>
+#include <functional>
 #include <list>
+#include <utility>
 #include <vector>
+#include "ParallelSort.h"
+
+// Eager pipelines, every stage runs over the whole vector before the next one starts
+// Each stage takes its input by value and works on it in place, so an rvalue input is moved from stage to
+// stage and a pipeline over one owns a single buffer from start to end. An lvalue input is copied once, by
+// the first stage
 
 namespace range {
 
 template <typename T>
 using Range = std::vector<T>;
 
-template <typename T>
-class copy_if
+// The stages are templated on the operation, which the compiler inlines into the loop of the stage and
+// which may be any callable, a capturing lambda included
+template <typename UnaryPredicate>
+class copy_if_stage
 {
-    bool (*m_pred)(T);
+    UnaryPredicate m_pred;
 
 public:
-    template <typename UnaryPredicate>
-    explicit copy_if(UnaryPredicate pred)
+    explicit copy_if_stage(UnaryPredicate pred)
         : m_pred(pred)
     {
     }
 
+    // compact the kept elements to the front of the input instead of copying them to a new vector
+    template <typename T>
     Range<T> operator()(Range<T> vSrc)
     {
-        Range<T> vOut;
-        std::copy_if(vSrc.begin(), vSrc.end(), std::back_inserter(vOut), m_pred);
-        return vOut;
+        vSrc.erase(std::remove_if(vSrc.begin(), vSrc.end(), [&pred = m_pred](const T& t) { return !pred(t); }), vSrc.end());
+        return vSrc;
     }
 };
 
+// The element type comes from the range, T is accepted for callers that name it
+template <typename T = void, typename UnaryPredicate>
+copy_if_stage<UnaryPredicate> copy_if(UnaryPredicate pred)
+{
+    return copy_if_stage<UnaryPredicate>(pred);
+}
+
 class reverse
 {
 public:
@@ -53,18 +73,38 @@ public:
     }
 };
 
-template <typename T>
-class transform
+// sort on the thread pool, a radix sort for integral and floating-point elements and a parallel merge sort
+// for the others
+class parallel_sort
 {
-    T (*m_op)(T);
+public:
+    template <typename T>
+    Range<T> operator()(Range<T> vSrc)
+    {
+        if constexpr (::Range::detail::is_radix_sortable<T>::value)
+        {
+            ::Range::radix_sort(vSrc.begin(), vSrc.end());
+        }
+        else
+        {
+            ::Range::parallel_sort(vSrc.begin(), vSrc.end());
+        }
+        return vSrc;
+    }
+};
+
+template <typename UnaryFunction>
+class transform_stage
+{
+    UnaryFunction m_op;
 
 public:
-    template <typename UnaryFunction>
-    explicit transform(UnaryFunction op)
+    explicit transform_stage(UnaryFunction op)
         : m_op(op)
     {
     }
 
+    template <typename T>
     Range<T> operator()(Range<T> vSrc)
     {
         std::transform(vSrc.begin(), vSrc.end(), vSrc.begin(), m_op);
@@ -72,28 +112,81 @@ public:
     }
 };
 
-template <typename T>
-Range<T> operator|(Range<T> lhs, copy_if<T> op)
+template <typename T = void, typename UnaryFunction>
+transform_stage<UnaryFunction> transform(UnaryFunction op)
+{
+    return transform_stage<UnaryFunction>(op);
+}
+
+// the k greatest elements under comp, greatest first, as sort | reverse and keeping k would give
+// nth_element partitions the k off in linear time and only they are sorted
+template <typename Compare>
+class top_k_stage
+{
+    std::size_t m_nCount;
+    Compare m_comp;
+
+public:
+    top_k_stage(std::size_t k, Compare comp)
+        : m_nCount(k)
+        , m_comp(comp)
+    {
+    }
+
+    template <typename T>
+    Range<T> operator()(Range<T> vSrc)
+    {
+        auto greater = [&comp = m_comp](const T& lhs, const T& rhs) { return comp(rhs, lhs); };
+        if (m_nCount < vSrc.size())
+        {
+            std::nth_element(vSrc.begin(), vSrc.begin() + m_nCount, vSrc.end(), greater);
+            vSrc.erase(vSrc.begin() + m_nCount, vSrc.end());
+        }
+        std::sort(vSrc.begin(), vSrc.end(), greater);
+        return vSrc;
+    }
+};
+
+template <typename Compare = std::less<> >
+top_k_stage<Compare> top_k(std::size_t k, Compare comp = Compare())
+{
+    return top_k_stage<Compare>(k, comp);
+}
+
+template <typename T, typename UnaryPredicate>
+Range<T> operator|(Range<T> lhs, copy_if_stage<UnaryPredicate> op)
 {
-    return op(lhs);
+    return op(std::move(lhs));
 }
 
 template <typename T>
 Range<T> operator|(Range<T> lhs, reverse op)
 {
-    return op(lhs);
+    return op(std::move(lhs));
 }
 
 template <typename T>
 Range<T> operator|(Range<T> lhs, sort op)
 {
-    return op(lhs);
+    return op(std::move(lhs));
 }
 
 template <typename T>
-Range<T> operator|(Range<T> lhs, transform<T> op)
+Range<T> operator|(Range<T> lhs, parallel_sort op)
+{
+    return op(std::move(lhs));
+}
+
+template <typename T, typename UnaryFunction>
+Range<T> operator|(Range<T> lhs, transform_stage<UnaryFunction> op)
 {
-    return op(lhs);
+    return op(std::move(lhs));
+}
+
+template <typename T, typename Compare>
+Range<T> operator|(Range<T> lhs, top_k_stage<Compare> op)
+{
+    return op(std::move(lhs));
 }
 
 namespace RangeTest {
@@ -107,6 +200,27 @@ inline void RunRangeTest()
 
     IntRange Input1 = { 4, 1, 2, 6, 5, 3 };
     IntRange Output = Input1 | range::sort() | range::reverse() | range::transform<int>(Mult) | range::copy_if<int>(IsEven);
+    assert((Output == IntRange{ 18, 12, 6 }));
+    assert(Input1.size() == 6);
+
+    // an rvalue input runs through every stage in its own buffer
+    const int* pData = Input1.data();
+    Output = std::move(Input1) | range::sort() | range::reverse() | range::transform<int>(Mult) | range::copy_if<int>(IsEven);
+    assert((Output == IntRange{ 18, 12, 6 }));
+    assert(Output.data() == pData);
+
+    // any callable, capturing lambdas included
+    int factor = 2;
+    Output = IntRange{ 1, 2, 3 } | range::transform([factor](int x) { return x * factor; }) | range::copy_if([factor](int x) { return x > factor; });
+    assert((Output == IntRange{ 4, 6 }));
+
+    Output = IntRange{ 4, -1, 2, 6, 5, 3 } | range::parallel_sort() | range::reverse();
+    assert((Output == IntRange{ 6, 5, 4, 3, 2, -1 }));
+
+    Output = IntRange{ 4, 1, 2, 6, 5, 3 } | range::top_k(3);
+    assert((Output == IntRange{ 6, 5, 4 }));
+    Output = IntRange{ 4, 1, 2 } | range::top_k(5, std::greater<>());
+    assert((Output == IntRange{ 1, 2, 4 }));
 
     printf("done");
 }
@@ -186,6 +300,11 @@ public:
     iter_type begin() { return m_c.begin(); }
     iter_type end() { return m_c.end(); }
 
+    std::size_t size() const { return m_c.size(); }
+    const value_type* data() const { return m_c.data(); }
+
+    iter_type erase(iter_type first, iter_type last) { return m_c.erase(first, last); }
+
 private:
     container_type m_c;
 };
@@ -212,18 +331,36 @@ public:
     }
 };
 
-template <typename T>
-class transform
+class parallel_sort
+{
+public:
+    template <typename T>
+    Range<T> operator()(Range<T> vSrc)
+    {
+        if constexpr (::Range::detail::is_radix_sortable<T>::value)
+        {
+            ::Range::radix_sort(vSrc.begin(), vSrc.end());
+        }
+        else
+        {
+            ::Range::parallel_sort(vSrc.begin(), vSrc.end());
+        }
+        return vSrc;
+    }
+};
+
+template <typename UnaryFunction>
+class transform_stage
 {
-    T (*m_op)(T);
+    UnaryFunction m_op;
 
 public:
-    template <typename UnaryFunction>
-    explicit transform(UnaryFunction op)
+    explicit transform_stage(UnaryFunction op)
         : m_op(op)
     {
     }
 
+    template <typename T>
     Range<T> operator()(Range<T> vSrc)
     {
         std::transform(vSrc.begin(), vSrc.end(), vSrc.begin(), m_op);
@@ -231,22 +368,105 @@ public:
     }
 };
 
+template <typename T = void, typename UnaryFunction>
+transform_stage<UnaryFunction> transform(UnaryFunction op)
+{
+    return transform_stage<UnaryFunction>(op);
+}
+
+template <typename Compare>
+class top_k_stage
+{
+    std::size_t m_nCount;
+    Compare m_comp;
+
+public:
+    top_k_stage(std::size_t k, Compare comp)
+        : m_nCount(k)
+        , m_comp(comp)
+    {
+    }
+
+    template <typename T>
+    Range<T> operator()(Range<T> vSrc)
+    {
+        auto greater = [&comp = m_comp](const T& lhs, const T& rhs) { return comp(rhs, lhs); };
+        if (m_nCount < vSrc.size())
+        {
+            std::nth_element(vSrc.begin(), vSrc.begin() + m_nCount, vSrc.end(), greater);
+            vSrc.erase(vSrc.begin() + m_nCount, vSrc.end());
+        }
+        std::sort(vSrc.begin(), vSrc.end(), greater);
+        return vSrc;
+    }
+};
+
+template <typename Compare = std::less<> >
+top_k_stage<Compare> top_k(std::size_t k, Compare comp = Compare())
+{
+    return top_k_stage<Compare>(k, comp);
+}
+
+template <typename UnaryPredicate>
+class copy_if_stage
+{
+    UnaryPredicate m_pred;
+
+public:
+    explicit copy_if_stage(UnaryPredicate pred)
+        : m_pred(pred)
+    {
+    }
+
+    // compact the kept elements to the front of the input
+    template <typename T>
+    Range<T> operator()(Range<T> vSrc)
+    {
+        vSrc.erase(std::remove_if(vSrc.begin(), vSrc.end(), [&pred = m_pred](const T& t) { return !pred(t); }), vSrc.end());
+        return vSrc;
+    }
+};
+
+template <typename T = void, typename UnaryPredicate>
+copy_if_stage<UnaryPredicate> copy_if(UnaryPredicate pred)
+{
+    return copy_if_stage<UnaryPredicate>(pred);
+}
+
+template <typename T, typename UnaryPredicate>
+Range<T> operator|(Range<T> lhs, copy_if_stage<UnaryPredicate> op)
+{
+    return op(std::move(lhs));
+}
+
 template <typename T>
 Range<T> operator|(Range<T> lhs, reverse op)
 {
-    return op(lhs);
+    return op(std::move(lhs));
 }
 
 template <typename T>
 Range<T> operator|(Range<T> lhs, sort op)
 {
-    return op(lhs);
+    return op(std::move(lhs));
 }
 
 template <typename T>
-Range<T> operator|(Range<T> lhs, transform<T> op)
+Range<T> operator|(Range<T> lhs, parallel_sort op)
 {
-    return op(lhs);
+    return op(std::move(lhs));
+}
+
+template <typename T, typename UnaryFunction>
+Range<T> operator|(Range<T> lhs, transform_stage<UnaryFunction> op)
+{
+    return op(std::move(lhs));
+}
+
+template <typename T, typename Compare>
+Range<T> operator|(Range<T> lhs, top_k_stage<Compare> op)
+{
+    return op(std::move(lhs));
 }
 
 template <typename T>
@@ -286,13 +506,22 @@ inline void Range2Test()
     Range<int> r3 = make_range<int>();
 
     auto Mult = [](int x) { return x * 3; };
-    //auto IsEven = [](int x) { return x % 2 == 0; };
+    auto IsEven = [](int x) { return x % 2 == 0; };
 
     auto Output = intRange | range2::reverse() | range2::transform<int>(Mult) | range2::sort();
+    assert(*Output.begin() == 3);
+    assert(*(intRange | range2::reverse() | range2::parallel_sort()).begin() == 1);
+    Range<int> Top = intRange | range2::top_k(2);
+    assert(Top.size() == 2 && *Top.begin() == 5);
 
     Range<int> X;
     X = intRange | range2::reverse() | range2::transform<int>(Mult) | range2::sort();
 
+    // an rvalue input is compacted in place and keeps its buffer
+    const int* pData = r3.data();
+    Range<int> Even = std::move(r3) | range2::transform<int>(Mult) | range2::copy_if<int>(IsEven) | range2::reverse();
+    assert(Even.size() == 2 && *Even.begin() == 42 && Even.data() == pData);
+
     //for (auto i = Output.begin(); i != Output.end(); ++i)
     //{
     //    Mercury::Trace("%d\n", *i);
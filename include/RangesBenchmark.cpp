@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "AllocationCounter.h"
+#include "Benchmark.h"
+#include "ParallelSort.h"
+#include "Ranges.h"
+
+// Runs the eager pipelines of Ranges.h over an lvalue and an rvalue input
+// bytes is the heap memory the pipeline allocated, link AllocationCounter.cpp to measure it. An lvalue input
+// is copied by the first stage, an rvalue one is moved through every stage and the pipeline allocates nothing
+// The sort rows compare std::sort with the parallel sorts of ParallelSort.h across sizes and distributions of
+// the input. Every row sorts a fresh copy of the input, the copy row is the part of each time spent copying
+namespace RangesBenchmark {
+
+static constexpr std::size_t Elements = 4 * 1024 * 1024;
+
+struct Mult
+{
+    int operator()(int x) const { return x * 3; }
+};
+
+struct Inc
+{
+    int operator()(int x) const { return x + 1; }
+};
+
+struct IsEven
+{
+    bool operator()(int x) const { return x % 2 == 0; }
+};
+
+static const std::vector<int>& Source()
+{
+    static const std::vector<int> source = [] {
+        std::vector<int> v(Elements);
+        std::iota(v.begin(), v.end(), 0);
+        return v;
+    }();
+    return source;
+}
+
+// The input is copied before the count starts, so both variants pay for the same copy in time and bytes
+// measures the pipeline alone
+template <bool Rvalue>
+static void RangePipeline(std::size_t& bytes)
+{
+    std::vector<int> input = Source();
+    AllocationCounter::ScopedCount count;
+    range::Range<int> output;
+    if constexpr (Rvalue)
+    {
+        output = std::move(input) | range::transform(Mult()) | range::copy_if(IsEven()) | range::reverse() | range::transform(Inc());
+    }
+    else
+    {
+        output = input | range::transform(Mult()) | range::copy_if(IsEven()) | range::reverse() | range::transform(Inc());
+    }
+    bytes = count.bytes();
+    Benchmark::DoNotOptimize(output.data());
+}
+
+template <bool Rvalue>
+static void Range2Pipeline(std::size_t& bytes)
+{
+    range2::Range<int> input(Source());
+    AllocationCounter::ScopedCount count;
+    range2::Range<int> output;
+    if constexpr (Rvalue)
+    {
+        output = std::move(input) | range2::transform(Mult()) | range2::copy_if(IsEven()) | range2::reverse() | range2::transform(Inc());
+    }
+    else
+    {
+        output = input | range2::transform(Mult()) | range2::copy_if(IsEven()) | range2::reverse() | range2::transform(Inc());
+    }
+    bytes = count.bytes();
+    Benchmark::DoNotOptimize(output.data());
+}
+
+// The same four passes written as loops over the vector
+static void HandWrittenPipeline(std::size_t& bytes)
+{
+    std::vector<int> v = Source();
+    AllocationCounter::ScopedCount count;
+    for (int& x : v)
+    {
+        x = Mult()(x);
+    }
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < v.size(); ++i)
+    {
+        if (IsEven()(v[i]))
+        {
+            v[kept++] = v[i];
+        }
+    }
+    v.resize(kept);
+    std::reverse(v.begin(), v.end());
+    for (int& x : v)
+    {
+        x = Inc()(x);
+    }
+    bytes = count.bytes();
+    Benchmark::DoNotOptimize(v.data());
+}
+
+// The 100 greatest elements of a shuffled input, by sorting all of it and by top_k
+template <bool TopK>
+static void RangeTopK(std::size_t& bytes)
+{
+    static const std::vector<int> shuffled = [] {
+        std::vector<int> v(Source());
+        std::shuffle(v.begin(), v.end(), std::mt19937(1));
+        return v;
+    }();
+
+    std::vector<int> input = shuffled;
+    AllocationCounter::ScopedCount count;
+    range::Range<int> output;
+    if constexpr (TopK)
+    {
+        output = std::move(input) | range::top_k(100);
+    }
+    else
+    {
+        output = std::move(input) | range::sort() | range::reverse();
+        output.resize(100);
+    }
+    bytes = count.bytes();
+    Benchmark::DoNotOptimize(output.data());
+}
+
+template <void (*Workload)(std::size_t&)>
+static void Run(const char* suite, const char* name)
+{
+    std::size_t bytes = 0;
+    Benchmark::Result r = Benchmark::Measure(suite, name, Elements, Elements, [&bytes] { Workload(bytes); }, 5);
+    r.bytes = bytes;
+    Benchmark::Report(r);
+}
+
+enum class Distribution
+{
+    Random,
+    Sorted,
+    Reversed,
+    FewUnique
+};
+
+static const char* DistributionName(Distribution distribution)
+{
+    switch (distribution)
+    {
+        case Distribution::Random:
+            return "random";
+        case Distribution::Sorted:
+            return "sorted";
+        case Distribution::Reversed:
+            return "reversed";
+        default:
+            return "few unique";
+    }
+}
+
+template <typename T>
+static std::vector<T> SortInput(std::size_t size, Distribution distribution)
+{
+    std::mt19937 engine(1);
+    std::vector<T> v(size);
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        std::uniform_real_distribution<T> values(-1.0e6, 1.0e6);
+        std::generate(v.begin(), v.end(), [&] { return values(engine); });
+    }
+    else
+    {
+        std::generate(v.begin(), v.end(), [&engine] { return static_cast<T>(engine()); });
+    }
+
+    if (distribution == Distribution::FewUnique)
+    {
+        for (T& x : v)
+        {
+            x = static_cast<T>(static_cast<std::size_t>(engine()) % 16);
+        }
+    }
+    else if (distribution != Distribution::Random)
+    {
+        std::sort(v.begin(), v.end());
+        if (distribution == Distribution::Reversed)
+        {
+            std::reverse(v.begin(), v.end());
+        }
+    }
+    return v;
+}
+
+template <typename T>
+static void RunSort(const char* type, std::size_t size, Distribution distribution)
+{
+    const std::vector<T> input = SortInput<T>(size, distribution);
+    const std::string suite = std::string("sort ") + type + " " + DistributionName(distribution);
+
+    auto sort = [&input](auto fn) {
+        return [&input, fn] {
+            std::vector<T> v(input);
+            fn(v);
+            Benchmark::DoNotOptimize(v.data());
+        };
+    };
+
+    using Benchmark::Measure;
+    using Benchmark::Report;
+    Report(Measure(suite.c_str(), "copy", size, size, sort([](std::vector<T>&) {}), 5));
+    Report(Measure(suite.c_str(), "std::sort", size, size, sort([](std::vector<T>& v) { std::sort(v.begin(), v.end()); }), 5));
+    Report(Measure(suite.c_str(), "parallel_sort", size, size, sort([](std::vector<T>& v) { Range::parallel_sort(v.begin(), v.end()); }), 5));
+    Report(Measure(suite.c_str(), "radix_sort", size, size, sort([](std::vector<T>& v) { Range::radix_sort(v.begin(), v.end()); }), 5));
+}
+
+}  // namespace RangesBenchmark
+
+void RunRangesBenchmark()
+{
+    using namespace RangesBenchmark;
+
+    Source();
+
+    Run<HandWrittenPipeline>("range transform|copy_if|reverse|transform", "hand-written");
+    Run<RangePipeline<false> >("range transform|copy_if|reverse|transform", "lvalue");
+    Run<RangePipeline<true> >("range transform|copy_if|reverse|transform", "rvalue");
+    Run<Range2Pipeline<false> >("range2 transform|copy_if|reverse|transform", "lvalue");
+    Run<Range2Pipeline<true> >("range2 transform|copy_if|reverse|transform", "rvalue");
+    Run<RangeTopK<false> >("range top 100", "sort|reverse");
+    Run<RangeTopK<true> >("range top 100", "top_k");
+
+    for (std::size_t size : { std::size_t(64 * 1024), std::size_t(1024 * 1024), std::size_t(16 * 1024 * 1024) })
+    {
+        for (Distribution distribution : { Distribution::Random, Distribution::Sorted, Distribution::Reversed, Distribution::FewUnique })
+        {
+            RunSort<int>("int", size, distribution);
+        }
+        RunSort<float>("float", size, Distribution::Random);
+    }
+}
@@ -0,0 +1,190 @@
+#pragma once
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "IteratorTraits.h"
+#include "Range.h"
+
+// Ranges whose end is a sentinel rather than an iterator
+// A sentinel only has to compare with the range's iterators, so it carries no more state than the end test
+// needs: unreachable_sentinel carries none and its comparison folds away, which is what makes an infinite
+// generate() loop test free. Range-based for accepts a begin and end of different types
+
+// clang-format off
+namespace Range
+{
+// clang-format on
+
+// End of a range that never ends, compares unequal to every iterator
+struct unreachable_sentinel
+{
+};
+
+namespace detail {
+
+// is_input_iterator for any type, false rather than a hard error for a type without iterator_traits
+template <typename T, typename = void>
+struct is_input_iterator_type : std::false_type
+{
+};
+
+template <typename T>
+struct is_input_iterator_type<T, std::void_t<typename std::iterator_traits<T>::iterator_category> > : is_input_iterator<T>
+{
+};
+
+template <typename Iterator>
+using enable_if_input_iterator_t = typename std::enable_if<is_input_iterator_type<Iterator>::value>::type;
+
+}  // namespace detail
+
+template <typename Iterator, typename = detail::enable_if_input_iterator_t<Iterator> >
+constexpr bool operator==(const Iterator&, unreachable_sentinel)
+{
+    return false;
+}
+
+template <typename Iterator, typename = detail::enable_if_input_iterator_t<Iterator> >
+constexpr bool operator==(unreachable_sentinel, const Iterator&)
+{
+    return false;
+}
+
+template <typename Iterator, typename = detail::enable_if_input_iterator_t<Iterator> >
+constexpr bool operator!=(const Iterator&, unreachable_sentinel)
+{
+    return true;
+}
+
+template <typename Iterator, typename = detail::enable_if_input_iterator_t<Iterator> >
+constexpr bool operator!=(unreachable_sentinel, const Iterator&)
+{
+    return true;
+}
+
+// End of an adaptor over a sentinel range, an adaptor iterator is at the end when its base() is
+template <typename BaseSentinel>
+class adaptor_sentinel final
+{
+public:
+    adaptor_sentinel() = default;
+
+    explicit adaptor_sentinel(BaseSentinel end)
+        : m_end(end)
+    {
+    }
+
+    const BaseSentinel& base() const { return m_end; }
+
+private:
+    BaseSentinel m_end{};
+};
+
+template <>
+class adaptor_sentinel<unreachable_sentinel> final
+{
+public:
+    adaptor_sentinel() = default;
+    explicit adaptor_sentinel(unreachable_sentinel) {}
+
+    unreachable_sentinel base() const { return unreachable_sentinel(); }
+};
+
+template <typename Iterator, typename BaseSentinel>
+auto operator==(const Iterator& it, const adaptor_sentinel<BaseSentinel>& s) -> decltype(it.base() == s.base())
+{
+    return it.base() == s.base();
+}
+
+template <typename Iterator, typename BaseSentinel>
+auto operator!=(const Iterator& it, const adaptor_sentinel<BaseSentinel>& s) -> decltype(it.base() == s.base())
+{
+    return !(it.base() == s.base());
+}
+
+namespace detail {
+
+// base() of the end of an adaptor, an unreachable end is its own base
+template <typename Sentinel>
+auto sentinel_base(const Sentinel& last) -> decltype(last.base())
+{
+    return last.base();
+}
+
+inline unreachable_sentinel sentinel_base(unreachable_sentinel)
+{
+    return unreachable_sentinel();
+}
+
+}  // namespace detail
+
+// Range of [first, last) where last is a sentinel
+template <typename Iterator, typename Sentinel>
+class SentinelRange
+{
+public:
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+    using sentinel = Sentinel;
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+    SentinelRange() = default;
+
+    SentinelRange(Iterator first, Sentinel last)
+        : m_first(first)
+        , m_last(last)
+    {
+    }
+
+    Iterator begin() const { return m_first; }
+    Sentinel end() const { return m_last; }
+
+private:
+    Iterator m_first{};
+    Sentinel m_last{};
+};
+
+template <typename Iterator, typename Sentinel>
+SentinelRange<Iterator, Sentinel> make_sentinel_range(Iterator first, Sentinel last)
+{
+    return SentinelRange<Iterator, Sentinel>(first, last);
+}
+
+// The algorithms of Range.h for sentinel ranges, which the iterator-pair standard algorithms cannot take
+
+template <typename Container, typename Iterator, typename Sentinel>
+void copy_range(Container& c, const SentinelRange<Iterator, Sentinel>& range)
+{
+    for (auto it = range.begin(); it != range.end(); ++it)
+    {
+        c.push_back(*it);
+    }
+}
+
+template <typename Container, typename Iterator, typename Sentinel>
+void push_back(Container& c, const SentinelRange<Iterator, Sentinel>& range)
+{
+    copy_range(c, range);
+}
+
+template <typename Iterator, typename Sentinel, typename OutputIterator>
+OutputIterator copy(const SentinelRange<Iterator, Sentinel>& range, OutputIterator out)
+{
+    for (auto it = range.begin(); it != range.end(); ++it)
+    {
+        *out++ = *it;
+    }
+    return out;
+}
+
+template <typename Iterator, typename Sentinel, typename T>
+T accumulate(const SentinelRange<Iterator, Sentinel>& range, T init)
+{
+    for (auto it = range.begin(); it != range.end(); ++it)
+    {
+        init = std::move(init) + *it;
+    }
+    return init;
+}
+
+}  // namespace Range
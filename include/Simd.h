@@ -0,0 +1,138 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+// Vector kernels used by the block evaluation of adaptor pipelines
+// The instruction set is chosen when compiling: AVX2 with /arch:AVX2 or -mavx2, SSSE3 with -mssse3, plain
+// loops otherwise
+
+// clang-format off
+namespace Simd
+{
+// clang-format on
+
+// Elements past the end of the output that compress may write, callers size their buffers n + CompressPadding
+constexpr std::size_t CompressPadding = 8;
+
+namespace detail {
+
+// Lane indices that move the lanes selected by each 8-bit mask to the front, for vpermd
+struct CompressTable8
+{
+    std::array<std::array<std::uint32_t, 8>, 256> m_Index{};
+    std::array<std::uint8_t, 256> m_Count{};
+
+    constexpr CompressTable8()
+    {
+        for (std::size_t mask = 0; mask < 256; ++mask)
+        {
+            std::size_t k = 0;
+            for (std::uint32_t lane = 0; lane < 8; ++lane)
+            {
+                if (mask & (std::size_t(1) << lane))
+                {
+                    m_Index[mask][k++] = lane;
+                }
+            }
+            m_Count[mask] = static_cast<std::uint8_t>(k);
+        }
+    }
+};
+
+// Byte shuffles that move the 32-bit lanes selected by each 4-bit mask to the front, for pshufb
+struct CompressTable4
+{
+    std::array<std::array<std::uint8_t, 16>, 16> m_Shuffle{};
+    std::array<std::uint8_t, 16> m_Count{};
+
+    constexpr CompressTable4()
+    {
+        for (std::size_t mask = 0; mask < 16; ++mask)
+        {
+            std::size_t k = 0;
+            for (std::size_t lane = 0; lane < 4; ++lane)
+            {
+                if (mask & (std::size_t(1) << lane))
+                {
+                    for (std::size_t byte = 0; byte < 4; ++byte)
+                    {
+                        m_Shuffle[mask][k * 4 + byte] = static_cast<std::uint8_t>(lane * 4 + byte);
+                    }
+                    ++k;
+                }
+            }
+            for (std::size_t byte = k * 4; byte < 16; ++byte)
+            {
+                m_Shuffle[mask][byte] = 0x80;
+            }
+            m_Count[mask] = static_cast<std::uint8_t>(k);
+        }
+    }
+};
+
+template <typename T>
+std::size_t CompressScalar(const T* in, const bool* keep, std::size_t n, T* out, std::size_t i, std::size_t k)
+{
+    // branchless, every element is written and the output only advances past the kept ones
+    for (; i < n; ++i)
+    {
+        out[k] = in[i];
+        k += keep[i];
+    }
+    return k;
+}
+
+}  // namespace detail
+
+// Copy the elements of in[0, n) whose keep flag is set to out, in order, and return how many were kept
+// out may receive up to CompressPadding elements past the last one kept
+template <typename T>
+std::size_t Compress(const T* in, const bool* keep, std::size_t n, T* out)
+{
+    std::size_t i = 0;
+    std::size_t k = 0;
+
+#if defined(__AVX2__)
+    if constexpr (sizeof(T) == 4)
+    {
+        static constexpr detail::CompressTable8 table;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m128i flags = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(keep + i));
+            const int mask = _mm_movemask_epi8(_mm_cmpgt_epi8(flags, _mm_setzero_si128())) & 0xFF;
+            const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(table.m_Index[mask].data()));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k), _mm256_permutevar8x32_epi32(values, index));
+            k += table.m_Count[mask];
+        }
+    }
+#elif defined(__SSSE3__)
+    if constexpr (sizeof(T) == 4)
+    {
+        static constexpr detail::CompressTable4 table;
+        for (; i + 4 <= n; i += 4)
+        {
+            std::int32_t flagBytes;
+            std::memcpy(&flagBytes, keep + i, sizeof(flagBytes));
+            const __m128i flags = _mm_cvtsi32_si128(flagBytes);
+            const int mask = _mm_movemask_epi8(_mm_cmpgt_epi8(flags, _mm_setzero_si128())) & 0xF;
+            const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            const __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.m_Shuffle[mask].data()));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + k), _mm_shuffle_epi8(values, shuffle));
+            k += table.m_Count[mask];
+        }
+    }
+#endif
+
+    return detail::CompressScalar(in, keep, n, out, i, k);
+}
+
+}  // namespace Simd
@@ -0,0 +1,181 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "Filter.h"
+#include "Generate.h"
+#include "IteratorTraits.h"
+#include "Range.h"
+#include "Sentinel.h"
+#include "Take.h"
+#include "Transform.h"
+
+// Number of elements an adaptor pipeline will yield, worked out from its iterators without running it
+// transform, reverse and take keep the size of their base, filter turns it into an upper bound and take
+// caps it at its count. A base that cannot say how long it is, a list or an input range, leaves the size
+// unknown, unless it is unbounded and a take ends it
+
+// clang-format off
+namespace Range
+{
+// clang-format on
+
+namespace detail {
+
+enum class size_kind
+{
+    unknown,
+    upper_bound,
+    exact
+};
+
+struct size_hint
+{
+    size_kind kind = size_kind::unknown;
+    std::size_t size = 0;
+};
+
+inline size_hint exact_size(std::size_t n)
+{
+    return size_hint{ size_kind::exact, n };
+}
+
+// Size of [first, last), last is the end iterator or the sentinel of the range
+template <typename Iterator>
+struct iterator_size
+{
+    template <typename Last>
+    static size_hint get(const Iterator& first, const Last& last)
+    {
+        if constexpr (std::is_same<Iterator, Last>::value && is_random_access_iterator<Iterator>::value)
+        {
+            return exact_size(static_cast<std::size_t>(last - first));
+        }
+        else
+        {
+            return size_hint();
+        }
+    }
+};
+
+template <typename BaseIterator, typename UnaryOperation>
+struct iterator_size<transform_iterator<BaseIterator, UnaryOperation> >
+{
+    template <typename Last>
+    static size_hint get(const transform_iterator<BaseIterator, UnaryOperation>& first, const Last& last)
+    {
+        return iterator_size<BaseIterator>::get(first.base(), sentinel_base(last));
+    }
+};
+
+template <typename BaseIterator, typename UnaryPredicate, typename BaseSentinel>
+struct iterator_size<filter_iterator<BaseIterator, UnaryPredicate, BaseSentinel> >
+{
+    template <typename Last>
+    static size_hint get(const filter_iterator<BaseIterator, UnaryPredicate, BaseSentinel>& first, const Last& last)
+    {
+        size_hint hint = iterator_size<BaseIterator>::get(first.base(), sentinel_base(last));
+        if (hint.kind == size_kind::exact)
+        {
+            hint.kind = size_kind::upper_bound;
+        }
+        return hint;
+    }
+};
+
+template <typename BaseIterator>
+struct iterator_size<take_iterator<BaseIterator> >
+{
+    template <typename Last>
+    static size_hint get(const take_iterator<BaseIterator>& first, const Last& last)
+    {
+        const size_hint base = iterator_size<BaseIterator>::get(first.base(), sentinel_base(last));
+        if (base.kind == size_kind::unknown)
+        {
+            // an unbounded base always has count elements left, any other may run out first
+            const bool unbounded = std::is_same<typename std::decay<decltype(sentinel_base(last))>::type, unreachable_sentinel>::value;
+            return size_hint{ unbounded ? size_kind::exact : size_kind::upper_bound, first.count() };
+        }
+        return size_hint{ base.kind, base.size < first.count() ? base.size : first.count() };
+    }
+};
+
+template <typename BaseIterator>
+struct iterator_size<std::reverse_iterator<BaseIterator> >
+{
+    template <typename Last>
+    static size_hint get(const std::reverse_iterator<BaseIterator>& first, const Last& last)
+    {
+        if constexpr (std::is_same<Last, std::reverse_iterator<BaseIterator> >::value)
+        {
+            return iterator_size<BaseIterator>::get(last.base(), first.base());
+        }
+        else
+        {
+            return size_hint();
+        }
+    }
+};
+
+template <typename NullaryOperation>
+struct iterator_size<generate_n_iterator<NullaryOperation> >
+{
+    template <typename Last>
+    static size_hint get(const generate_n_iterator<NullaryOperation>& first, const Last& last)
+    {
+        if constexpr (std::is_same<Last, generate_n_iterator<NullaryOperation> >::value)
+        {
+            return exact_size(last.position() - first.position());
+        }
+        else
+        {
+            return size_hint();
+        }
+    }
+};
+
+template <typename Rng, typename = void>
+struct has_size : std::false_type
+{
+};
+
+template <typename Rng>
+struct has_size<Rng, std::void_t<decltype(std::declval<const Rng&>().size())> > : std::true_type
+{
+};
+
+// Views are sized through their iterators, the size() of a view could walk it
+// A view that is not an IteratorRange or a SentinelRange specializes this next to its class
+template <typename Rng>
+struct is_view : std::false_type
+{
+};
+
+template <typename Iterator>
+struct is_view<IteratorRange<Iterator> > : std::true_type
+{
+};
+
+template <typename Iterator, typename Sentinel>
+struct is_view<SentinelRange<Iterator, Sentinel> > : std::true_type
+{
+};
+
+// Size of a container or of an adaptor view
+template <typename Rng>
+size_hint range_size(const Rng& range)
+{
+    if constexpr (has_size<Rng>::value && !is_view<Rng>::value)
+    {
+        return exact_size(static_cast<std::size_t>(range.size()));
+    }
+    else
+    {
+        return iterator_size<typename std::decay<decltype(range.begin())>::type>::get(range.begin(), range.end());
+    }
+}
+
+}  // namespace detail
+
+}  // namespace Range
@@ -0,0 +1,637 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Allocators that can grow an allocation in place, as the arena allocators can for their most recent allocation
+template <class Allocator, class = void>
+struct has_try_expand : std::false_type
+{
+};
+
+template <class Allocator>
+struct has_try_expand<Allocator, decltype(void(std::declval<Allocator&>().try_expand(
+                                     std::declval<typename std::allocator_traits<Allocator>::pointer>(), std::size_t(), std::size_t())))>
+    : std::true_type
+{
+};
+
+}  // namespace detail
+
+// Vector with storage for N elements inside the object, so short vectors never allocate
+// When the size grows past N the elements move to a buffer from Allocator, which may be the heap
+// or an arena through LocalAllocator. Iterators are plain pointers and are invalidated by any
+// operation that changes the capacity, as with std::vector
+// With an arena allocator a buffer that is the last allocation in its arena grows in place, so growth
+// neither copies the elements nor leaves the old buffer behind in the arena
+template <class T, std::size_t N, class Allocator = std::allocator<T> >
+class SmallVector
+{
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_type inline_capacity = N;
+
+    SmallVector() noexcept(std::is_nothrow_default_constructible<Allocator>::value)
+        : SmallVector(Allocator())
+    {
+    }
+
+    explicit SmallVector(const Allocator& a) noexcept
+        : m_pBegin(inline_data())
+        , m_nSize(0)
+        , m_nCapacity(N)
+        , m_Alloc(a)
+    {
+    }
+
+    explicit SmallVector(size_type n, const Allocator& a = Allocator())
+        : SmallVector(a)
+    {
+        resize(n);
+    }
+
+    SmallVector(size_type n, const value_type& value, const Allocator& a = Allocator())
+        : SmallVector(a)
+    {
+        assign(n, value);
+    }
+
+    template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+    SmallVector(InputIterator first, InputIterator last, const Allocator& a = Allocator())
+        : SmallVector(a)
+    {
+        assign(first, last);
+    }
+
+    SmallVector(std::initializer_list<value_type> il, const Allocator& a = Allocator())
+        : SmallVector(a)
+    {
+        assign(il.begin(), il.end());
+    }
+
+    SmallVector(const SmallVector& other)
+        : SmallVector(alloc_traits::select_on_container_copy_construction(other.m_Alloc))
+    {
+        assign(other.begin(), other.end());
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<value_type>::value)
+        : SmallVector(other.m_Alloc)
+    {
+        take_from(other);
+    }
+
+    ~SmallVector()
+    {
+        clear();
+        release();
+    }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this != &other)
+        {
+            if (alloc_traits::propagate_on_container_copy_assignment::value && m_Alloc != other.m_Alloc)
+            {
+                clear();
+                release();
+                m_Alloc = other.m_Alloc;
+            }
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<value_type>::value &&
+                                                         (alloc_traits::propagate_on_container_move_assignment::value ||
+                                                          std::is_empty<Allocator>::value))
+    {
+        if (this != &other)
+        {
+            clear();
+            if (alloc_traits::propagate_on_container_move_assignment::value || m_Alloc == other.m_Alloc)
+            {
+                release();
+                if (alloc_traits::propagate_on_container_move_assignment::value)
+                {
+                    m_Alloc = other.m_Alloc;
+                }
+                take_from(other);
+            }
+            else
+            {
+                // buffers from a different allocator cannot be adopted, move the elements instead
+                assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+                other.clear();
+            }
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(std::initializer_list<value_type> il)
+    {
+        assign(il.begin(), il.end());
+        return *this;
+    }
+
+    void assign(size_type n, const value_type& value)
+    {
+        if (n > capacity())
+        {
+            // value may refer to an element, copy it before the elements are destroyed
+            value_type copy(value);
+            clear();
+            grow(n);
+            std::uninitialized_fill_n(m_pBegin, n, copy);
+            m_nSize = n;
+            return;
+        }
+
+        std::fill_n(m_pBegin, std::min(n, m_nSize), value);
+        if (n > m_nSize)
+        {
+            std::uninitialized_fill_n(end(), n - m_nSize, value);
+        }
+        else
+        {
+            destroy(m_pBegin + n, end());
+        }
+        m_nSize = n;
+    }
+
+    template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+    void assign(InputIterator first, InputIterator last)
+    {
+        clear();
+        append(first, last, typename std::iterator_traits<InputIterator>::iterator_category{});
+    }
+
+    void assign(std::initializer_list<value_type> il) { assign(il.begin(), il.end()); }
+
+    allocator_type get_allocator() const { return m_Alloc; }
+
+    // Element access
+    reference at(size_type n)
+    {
+        if (n >= m_nSize)
+        {
+            throw std::out_of_range("SmallVector::at");
+        }
+        return m_pBegin[n];
+    }
+    const_reference at(size_type n) const
+    {
+        if (n >= m_nSize)
+        {
+            throw std::out_of_range("SmallVector::at");
+        }
+        return m_pBegin[n];
+    }
+
+    reference operator[](size_type n) { return m_pBegin[n]; }
+    const_reference operator[](size_type n) const { return m_pBegin[n]; }
+
+    reference front() { return m_pBegin[0]; }
+    const_reference front() const { return m_pBegin[0]; }
+    reference back() { return m_pBegin[m_nSize - 1]; }
+    const_reference back() const { return m_pBegin[m_nSize - 1]; }
+
+    pointer data() noexcept { return m_pBegin; }
+    const_pointer data() const noexcept { return m_pBegin; }
+
+    // Iterators
+    iterator begin() noexcept { return m_pBegin; }
+    const_iterator begin() const noexcept { return m_pBegin; }
+    const_iterator cbegin() const noexcept { return m_pBegin; }
+    iterator end() noexcept { return m_pBegin + m_nSize; }
+    const_iterator end() const noexcept { return m_pBegin + m_nSize; }
+    const_iterator cend() const noexcept { return end(); }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    // Capacity
+    bool empty() const noexcept { return m_nSize == 0; }
+    size_type size() const noexcept { return m_nSize; }
+    size_type max_size() const noexcept { return alloc_traits::max_size(m_Alloc); }
+    size_type capacity() const noexcept { return m_nCapacity; }
+
+    // Returns whether the elements are held in the inline storage
+    bool is_inline() const noexcept { return m_pBegin == inline_data(); }
+
+    void reserve(size_type n)
+    {
+        if (n > m_nCapacity)
+        {
+            grow(n);
+        }
+    }
+
+    // Move the elements back into the inline storage when they fit, otherwise into an exactly sized buffer
+    void shrink_to_fit()
+    {
+        if (is_inline() || m_nSize == m_nCapacity)
+        {
+            return;
+        }
+
+        if (m_nSize <= N)
+        {
+            pointer pOld = m_pBegin;
+            uninitialized_move(pOld, pOld + m_nSize, inline_data());
+            destroy(pOld, pOld + m_nSize);
+            alloc_traits::deallocate(m_Alloc, pOld, m_nCapacity);
+            m_pBegin = inline_data();
+            m_nCapacity = N;
+        }
+        else
+        {
+            relocate(m_nSize);
+        }
+    }
+
+    // Modifiers
+    void clear() noexcept
+    {
+        destroy(m_pBegin, end());
+        m_nSize = 0;
+    }
+
+    iterator insert(const_iterator pos, const value_type& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, value_type&& value) { return emplace(pos, std::move(value)); }
+
+    iterator insert(const_iterator pos, size_type n, const value_type& value)
+    {
+        const size_type index = static_cast<size_type>(pos - begin());
+        const size_type oldSize = m_nSize;
+        if (n > 0)
+        {
+            value_type copy(value);
+            reserve(m_nSize + n);
+            std::uninitialized_fill_n(end(), n, copy);
+            m_nSize += n;
+            std::rotate(begin() + index, begin() + oldSize, end());
+        }
+        return begin() + index;
+    }
+
+    template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+    iterator insert(const_iterator pos, InputIterator first, InputIterator last)
+    {
+        // append the new elements, then rotate them into place
+        const size_type index = static_cast<size_type>(pos - begin());
+        const size_type oldSize = m_nSize;
+        append(first, last, typename std::iterator_traits<InputIterator>::iterator_category{});
+        std::rotate(begin() + index, begin() + oldSize, end());
+        return begin() + index;
+    }
+
+    iterator insert(const_iterator pos, std::initializer_list<value_type> il) { return insert(pos, il.begin(), il.end()); }
+
+    template <class... Args>
+    iterator emplace(const_iterator pos, Args&&... args)
+    {
+        const size_type index = static_cast<size_type>(pos - begin());
+        emplace_back(std::forward<Args>(args)...);
+        std::rotate(begin() + index, end() - 1, end());
+        return begin() + index;
+    }
+
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        iterator pFirst = begin() + (first - begin());
+        iterator pLast = begin() + (last - begin());
+        if (pFirst != pLast)
+        {
+            iterator pNewEnd = std::move(pLast, end(), pFirst);
+            destroy(pNewEnd, end());
+            m_nSize = static_cast<size_type>(pNewEnd - begin());
+        }
+        return pFirst;
+    }
+
+    void push_back(const value_type& value) { emplace_back(value); }
+    void push_back(value_type&& value) { emplace_back(std::move(value)); }
+
+    template <class... Args>
+    reference emplace_back(Args&&... args)
+    {
+        if (m_nSize == m_nCapacity)
+        {
+            return grow_emplace_back(std::forward<Args>(args)...);
+        }
+        alloc_traits::construct(m_Alloc, end(), std::forward<Args>(args)...);
+        ++m_nSize;
+        return back();
+    }
+
+    void pop_back()
+    {
+        assert(!empty());
+        --m_nSize;
+        alloc_traits::destroy(m_Alloc, end());
+    }
+
+    void resize(size_type n)
+    {
+        if (n > m_nSize)
+        {
+            reserve(n);
+            for (; m_nSize < n; ++m_nSize)
+            {
+                alloc_traits::construct(m_Alloc, end());
+            }
+        }
+        else
+        {
+            erase(begin() + n, end());
+        }
+    }
+
+    void resize(size_type n, const value_type& value)
+    {
+        if (n > m_nSize)
+        {
+            insert(end(), n - m_nSize, value);
+        }
+        else
+        {
+            erase(begin() + n, end());
+        }
+    }
+
+    void swap(SmallVector& other)
+    {
+        if (this == &other)
+        {
+            return;
+        }
+
+        if (!is_inline() && !other.is_inline())
+        {
+            std::swap(m_pBegin, other.m_pBegin);
+            std::swap(m_nSize, other.m_nSize);
+            std::swap(m_nCapacity, other.m_nCapacity);
+        }
+        else
+        {
+            // inline elements cannot change owner by swapping pointers, move through a temporary
+            SmallVector temp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temp);
+            return;
+        }
+
+        if (alloc_traits::propagate_on_container_swap::value)
+        {
+            using std::swap;
+            swap(m_Alloc, other.m_Alloc);
+        }
+    }
+
+private:
+    pointer inline_data() noexcept { return reinterpret_cast<pointer>(m_Inline); }
+    const_pointer inline_data() const noexcept { return reinterpret_cast<const_pointer>(m_Inline); }
+
+    void destroy(pointer first, pointer last) noexcept
+    {
+        for (; first != last; ++first)
+        {
+            alloc_traits::destroy(m_Alloc, first);
+        }
+    }
+
+    // Move construct [first, last) into uninitialized memory at dest, copying when the move could throw
+    void uninitialized_move(pointer first, pointer last, pointer dest)
+    {
+        pointer pStart = dest;
+        try
+        {
+            for (; first != last; ++first, ++dest)
+            {
+                alloc_traits::construct(m_Alloc, dest, std::move_if_noexcept(*first));
+            }
+        }
+        catch (...)
+        {
+            destroy(pStart, dest);
+            throw;
+        }
+    }
+
+    // Free the allocated buffer, the elements must already be destroyed
+    void release() noexcept
+    {
+        if (!is_inline())
+        {
+            alloc_traits::deallocate(m_Alloc, m_pBegin, m_nCapacity);
+            m_pBegin = inline_data();
+            m_nCapacity = N;
+        }
+    }
+
+    // Capacity for at least n elements, doubling so that push_back is amortized constant time
+    size_type next_capacity(size_type n) const noexcept { return std::max(n, m_nCapacity ? 2 * m_nCapacity : size_type(1)); }
+
+    void grow(size_type n)
+    {
+        // when the arena cannot double the buffer in place, it may still have room for exactly n
+        const size_type newCapacity = next_capacity(n);
+        if (!try_expand(newCapacity) && !try_expand(n))
+        {
+            relocate(newCapacity);
+        }
+    }
+
+    bool try_expand(size_type newCapacity) { return try_expand(newCapacity, detail::has_try_expand<Allocator>{}); }
+
+    bool try_expand(size_type newCapacity, std::true_type)
+    {
+        if (is_inline() || !m_Alloc.try_expand(m_pBegin, m_nCapacity, newCapacity))
+        {
+            return false;
+        }
+        m_nCapacity = newCapacity;
+        return true;
+    }
+
+    bool try_expand(size_type, std::false_type) noexcept { return false; }
+
+    // Move the elements into a newly allocated buffer of the given capacity
+    void relocate(size_type newCapacity)
+    {
+        pointer pNew = alloc_traits::allocate(m_Alloc, newCapacity);
+        try
+        {
+            uninitialized_move(m_pBegin, end(), pNew);
+        }
+        catch (...)
+        {
+            alloc_traits::deallocate(m_Alloc, pNew, newCapacity);
+            throw;
+        }
+        destroy(m_pBegin, end());
+        release();
+        m_pBegin = pNew;
+        m_nCapacity = newCapacity;
+    }
+
+    template <class... Args>
+    reference grow_emplace_back(Args&&... args)
+    {
+        const size_type newCapacity = next_capacity(m_nSize + 1);
+        if (try_expand(newCapacity) || try_expand(m_nSize + 1))
+        {
+            alloc_traits::construct(m_Alloc, end(), std::forward<Args>(args)...);
+            ++m_nSize;
+            return back();
+        }
+
+        // construct the new element first, args may refer to an element of this vector
+        pointer pNew = alloc_traits::allocate(m_Alloc, newCapacity);
+        try
+        {
+            alloc_traits::construct(m_Alloc, pNew + m_nSize, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            alloc_traits::deallocate(m_Alloc, pNew, newCapacity);
+            throw;
+        }
+
+        try
+        {
+            uninitialized_move(m_pBegin, end(), pNew);
+        }
+        catch (...)
+        {
+            alloc_traits::destroy(m_Alloc, pNew + m_nSize);
+            alloc_traits::deallocate(m_Alloc, pNew, newCapacity);
+            throw;
+        }
+
+        destroy(m_pBegin, end());
+        release();
+        m_pBegin = pNew;
+        m_nCapacity = newCapacity;
+        ++m_nSize;
+        return back();
+    }
+
+    template <class InputIterator>
+    void append(InputIterator first, InputIterator last, std::input_iterator_tag)
+    {
+        for (; first != last; ++first)
+        {
+            emplace_back(*first);
+        }
+    }
+
+    template <class ForwardIterator>
+    void append(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+    {
+        reserve(m_nSize + static_cast<size_type>(std::distance(first, last)));
+        for (; first != last; ++first)
+        {
+            alloc_traits::construct(m_Alloc, end(), *first);
+            ++m_nSize;
+        }
+    }
+
+    // Take the elements of other, adopting its buffer when it has one, this vector must be empty and inline
+    void take_from(SmallVector& other)
+    {
+        if (other.is_inline())
+        {
+            uninitialized_move(other.m_pBegin, other.end(), inline_data());
+            m_nSize = other.m_nSize;
+            other.clear();
+        }
+        else
+        {
+            m_pBegin = other.m_pBegin;
+            m_nSize = other.m_nSize;
+            m_nCapacity = other.m_nCapacity;
+            other.m_pBegin = other.inline_data();
+            other.m_nSize = 0;
+            other.m_nCapacity = N;
+        }
+    }
+
+    alignas(T) unsigned char m_Inline[N ? N * sizeof(T) : 1];
+    pointer m_pBegin;
+    size_type m_nSize;
+    size_type m_nCapacity;
+    Allocator m_Alloc;
+};
+
+template <class T, std::size_t N, class A>
+bool operator==(const SmallVector<T, N, A>& lhs, const SmallVector<T, N, A>& rhs)
+{
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class T, std::size_t N, class A>
+bool operator!=(const SmallVector<T, N, A>& lhs, const SmallVector<T, N, A>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <class T, std::size_t N, class A>
+bool operator<(const SmallVector<T, N, A>& lhs, const SmallVector<T, N, A>& rhs)
+{
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class T, std::size_t N, class A>
+bool operator>(const SmallVector<T, N, A>& lhs, const SmallVector<T, N, A>& rhs)
+{
+    return rhs < lhs;
+}
+
+template <class T, std::size_t N, class A>
+bool operator<=(const SmallVector<T, N, A>& lhs, const SmallVector<T, N, A>& rhs)
+{
+    return !(rhs < lhs);
+}
+
+template <class T, std::size_t N, class A>
+bool operator>=(const SmallVector<T, N, A>& lhs, const SmallVector<T, N, A>& rhs)
+{
+    return !(lhs < rhs);
+}
+
+template <class T, std::size_t N, class A>
+void swap(SmallVector<T, N, A>& lhs, SmallVector<T, N, A>& rhs)
+{
+    lhs.swap(rhs);
+}
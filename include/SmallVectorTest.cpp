@@ -0,0 +1,117 @@
+#if defined(_WIN32)
+#pragma warning(disable : 4189)  // local variable is initialized but not referenced
+#pragma warning(disable : 4101)  // unreferenced local variable
+#pragma warning(disable : 4100)  // unreferenced formal parameter
+#endif
+
+#include <cassert>
+#include <memory>
+#include <numeric>
+#include <string>
+#include "AllocationCounter.h"
+#include "MyAlloc.h"
+#include "SmallVector.h"
+
+namespace SmallVectorTest {
+
+static void DoInlineTests()
+{
+    {
+        SmallVector<int, 8> v;
+        {
+            // requests with up to 8 entries stay in the object
+            AllocationCounter::ExpectNoAllocations guard("SmallVector inline");
+
+            assert(v.empty() && v.is_inline() && v.capacity() == 8);
+            for (int i = 0; i < 8; ++i)
+            {
+                v.push_back(i);
+            }
+            assert(v.size() == 8 && v.is_inline());
+            assert(std::accumulate(v.begin(), v.end(), 0) == 28);
+        }
+
+        v.insert(v.begin(), 100);
+        assert(!v.is_inline());
+    }
+
+    {
+        SmallVector<int, 4> v{1, 2, 3};
+        v.insert(v.begin() + 1, {10, 11});
+        assert((v == SmallVector<int, 4>{1, 10, 11, 2, 3}));
+
+        v.erase(v.begin(), v.begin() + 2);
+        assert((v == SmallVector<int, 4>{11, 2, 3}));
+
+        v.emplace(v.end(), 4);
+        v.insert(v.begin(), 2, 0);
+        assert((v == SmallVector<int, 4>{0, 0, 11, 2, 3, 4}));
+
+        v.resize(2);
+        v.shrink_to_fit();
+        assert(v.is_inline() && v.size() == 2);
+
+        v.resize(5, 7);
+        assert(v.back() == 7 && v.size() == 5);
+        assert(v.at(2) == 7);
+    }
+
+    {
+        // inserting an element of the vector into itself while it grows
+        SmallVector<std::string, 2> v{"first", "second"};
+        v.push_back(v[0]);
+        v.insert(v.begin(), v[2]);
+        assert(v.size() == 4 && v[0] == "first" && v[3] == "first");
+    }
+}
+
+static void DoCopyMoveTests()
+{
+    SmallVector<std::string, 2> inlineStrings{"a", "b"};
+    SmallVector<std::string, 2> heapStrings{"c", "d", "e"};
+
+    SmallVector<std::string, 2> copy(heapStrings);
+    assert(copy == heapStrings && !copy.is_inline());
+
+    SmallVector<std::string, 2> moved(std::move(heapStrings));
+    assert(moved.size() == 3 && heapStrings.empty() && heapStrings.is_inline());
+
+    moved = std::move(inlineStrings);
+    assert(moved.size() == 2 && moved.is_inline() && moved[1] == "b");
+
+    copy.swap(moved);
+    assert(copy.size() == 2 && moved.size() == 3 && moved[2] == "e");
+    assert(copy < moved);
+
+    SmallVector<std::unique_ptr<int>, 1> owners;
+    owners.push_back(std::make_unique<int>(1));
+    owners.push_back(std::make_unique<int>(2));
+    owners.erase(owners.begin());
+    assert(owners.size() == 1 && *owners.front() == 2);
+}
+
+static void DoArenaTests()
+{
+    // overflow spills into the arena rather than the heap
+    StackArena<1024> arena;
+    LocalAllocator<int, 1024> alloc(arena);
+
+    AllocationCounter::ExpectNoAllocations guard("SmallVector arena spill");
+
+    SmallVector<int, 4, LocalAllocator<int, 1024> > v(alloc);
+    for (int i = 0; i < 32; ++i)
+    {
+        v.push_back(i);
+    }
+    assert(!v.is_inline() && arena.owns(v.data()));
+    assert(std::accumulate(v.begin(), v.end(), 0) == 496);
+}
+
+}  // namespace SmallVectorTest
+
+void RunSmallVectorTest()
+{
+    SmallVectorTest::DoInlineTests();
+    SmallVectorTest::DoCopyMoveTests();
+    SmallVectorTest::DoArenaTests();
+}
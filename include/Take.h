@@ -1,6 +1,7 @@
 #pragma once
 #include "IteratorTraits.h"
 #include "Range.h"
+#include "Sentinel.h"
 #include "View.h"
 
 // clang-format off
@@ -14,8 +15,7 @@ class take_iterator final
     static_assert(is_input_iterator<BaseIterator>::value, "take_iterator requires input iterator");
 
     BaseIterator m_iterator{};
-    size_t m_size = 0;
-    size_t m_current = 0;
+    size_t m_remaining = 0;
 
 public:
     // TODO: the iterator category should probably adapt to the base iterator, as filter does
@@ -29,10 +29,10 @@ public:
     // this is to accomodate applying take to a transform, whose operator* returns by value
     using DereferenceType = typename std::conditional<std::is_reference<decltype(*m_iterator)>::value, reference, value_type>::type;
 
-    explicit take_iterator(BaseIterator iter, size_t n, size_t current)
+    // n is the number of elements left to take
+    explicit take_iterator(BaseIterator iter, size_t n)
         : m_iterator(iter)
-        , m_size(n)
-        , m_current(current)
+        , m_remaining(n)
     {
     }
 
@@ -44,15 +44,28 @@ public:
     take_iterator& operator++()
     {
         ++m_iterator;
-        ++m_current;
+        --m_remaining;
         return *this;
     }
 
     // Required by InputIterator
     DereferenceType operator*() { return *m_iterator; }
 
-    bool operator==(const take_iterator& rhs) { return (m_current == rhs.m_current) || (m_iterator == rhs.m_iterator); }
-    bool operator!=(const take_iterator& rhs) { return !(*this == rhs); }
+    // iterators of the same range are at the same position when they have as many elements left
+    // Over a base that is not random access the count is not clamped to the base size, and the end of the
+    // range, which has none left, is also reached where the base ends
+    bool operator==(const take_iterator& rhs) const
+    {
+        if constexpr (is_random_access_iterator<BaseIterator>::value)
+        {
+            return m_remaining == rhs.m_remaining;
+        }
+        else
+        {
+            return m_remaining == rhs.m_remaining || m_iterator == rhs.m_iterator;
+        }
+    }
+    bool operator!=(const take_iterator& rhs) const { return !(*this == rhs); }
 
     // Required by ForwardIterator
     take_iterator() = default;
@@ -63,15 +76,93 @@ public:
         ++(*this);
         return temp;
     }
+
+    // Underlying iterator and number of elements left to take, used by Fusion.h
+    const BaseIterator& base() const { return m_iterator; }
+    size_t count() const { return m_remaining; }
 };
 
 template <typename BaseIterator>
-take_iterator<BaseIterator> make_take_iterator(BaseIterator iter, size_t n, size_t current)
+take_iterator<BaseIterator> make_take_iterator(BaseIterator iter, size_t n)
 {
     static_assert(is_iterator<take_iterator<BaseIterator> >::value, "is_iterator failed");
-    return take_iterator<BaseIterator>(iter, n, current);
+    return take_iterator<BaseIterator>(iter, n);
 }
 
+// End of a take range over a sentinel range, reached when the count runs out or the base range ends
+// When the base end is unreachable_sentinel its comparison folds away and the loop test is the count alone
+template <typename BaseSentinel>
+class take_sentinel final
+{
+public:
+    take_sentinel() = default;
+
+    explicit take_sentinel(BaseSentinel end)
+        : m_end(end)
+    {
+    }
+
+    const BaseSentinel& base() const { return m_end; }
+
+private:
+    BaseSentinel m_end{};
+};
+
+// Over an unbounded base only the count ends the range, and the sentinel is empty
+template <>
+class take_sentinel<unreachable_sentinel> final
+{
+public:
+    take_sentinel() = default;
+    explicit take_sentinel(unreachable_sentinel) {}
+
+    unreachable_sentinel base() const { return unreachable_sentinel(); }
+};
+
+template <typename BaseIterator, typename BaseSentinel>
+bool operator==(const take_iterator<BaseIterator>& it, const take_sentinel<BaseSentinel>& s)
+{
+    return it.count() == 0 || it.base() == s.base();
+}
+
+template <typename BaseIterator, typename BaseSentinel>
+bool operator!=(const take_iterator<BaseIterator>& it, const take_sentinel<BaseSentinel>& s)
+{
+    return !(it == s);
+}
+
+namespace detail {
+
+// A random-access base knows its size, so the count is clamped to it and the base end is never compared
+// The range is a common one ending at the iterator with no elements left, which the iterator-pair standard
+// algorithms and container constructors accept, and its loop test is still the one compare of the counts
+template <typename Iterator, typename Sentinel>
+using take_is_sized = std::integral_constant<bool, std::is_same<Iterator, Sentinel>::value && is_random_access_iterator<Iterator>::value>;
+
+template <typename Iterator>
+auto make_take_range(Iterator first, Iterator last, size_t n, std::true_type) -> IteratorRange<take_iterator<Iterator> >
+{
+    const size_t size = static_cast<size_t>(last - first);
+    const size_t count = n < size ? n : size;
+    return make_range(make_take_iterator(first, count), make_take_iterator(first + count, 0));
+}
+
+// Any other common base ends the range at its end with no elements left
+template <typename Iterator>
+auto make_take_range(Iterator first, Iterator last, size_t n, std::false_type) -> IteratorRange<take_iterator<Iterator> >
+{
+    return make_range(make_take_iterator(first, n), make_take_iterator(last, 0));
+}
+
+// A sentinel base ends the range at a take_sentinel
+template <typename Iterator, typename Sentinel>
+auto make_take_range(Iterator first, Sentinel last, size_t n, std::false_type) -> SentinelRange<take_iterator<Iterator>, take_sentinel<Sentinel> >
+{
+    return make_sentinel_range(make_take_iterator(first, n), take_sentinel<Sentinel>(last));
+}
+
+}  // namespace detail
+
 // clang-format off
 class take_holder : public detail::holder<size_t>
 {
@@ -85,18 +176,14 @@ inline take_holder take(size_t n)
     return take_holder(n);
 }
 
-// Construct view by applying take adaptor to the range
+// Construct view by applying take adaptor to the range, a container, IteratorRange or SentinelRange
 template <typename Rng>
-auto operator|(const Rng& range, take_holder taker) -> IteratorRange<take_iterator<typename Rng::const_iterator> >
-{
-    return make_range(make_take_iterator(range.begin(), taker.get(), 0), make_take_iterator(range.end(), taker.get(), taker.get()));
-}
-
-// Construct view by applying take adaptor to the range
-template <typename Iterator>
-auto operator|(const IteratorRange<Iterator>& range, take_holder taker) -> IteratorRange<take_iterator<Iterator> >
+auto operator|(const Rng& range, take_holder taker)
+    -> decltype(detail::make_take_range(range.begin(), range.end(), taker.get(),
+                                        detail::take_is_sized<decltype(range.begin()), decltype(range.end())>()))
 {
-    return make_range(make_take_iterator(range.begin(), taker.get(), 0), make_take_iterator(range.end(), taker.get(), taker.get()));
+    return detail::make_take_range(range.begin(), range.end(), taker.get(),
+                                   detail::take_is_sized<decltype(range.begin()), decltype(range.end())>());
 }
 
 }  // namespace Range
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running queued jobs
+// parallel_for is the only way work is handed out: the calling thread takes part and returns once every
+// index has run. A thread waiting for its own jobs runs other queued jobs meanwhile, so parallel_for may be
+// called from inside a job without the pool deadlocking
+class ThreadPool
+{
+public:
+    // threads is the number of workers, the thread calling parallel_for adds one more
+    explicit ThreadPool(std::size_t threads = DefaultThreads())
+    {
+        m_Workers.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            m_Workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_bStop = true;
+        }
+        m_Wake.notify_all();
+        for (auto& t : m_Workers)
+        {
+            t.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Threads that run a parallel_for, the workers and the caller
+    std::size_t concurrency() const noexcept { return m_Workers.size() + 1; }
+
+    // Run fn(i) for every i in [0, count), in any order and on any thread
+    // The first exception thrown by fn is rethrown here once all running calls have finished, indices not
+    // yet started when it was thrown are skipped
+    template <typename Function>
+    void parallel_for(std::size_t count, Function&& fn)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        Batch batch;
+        auto drain = [&batch, &fn, count] {
+            for (std::size_t i; (i = batch.m_nNext.fetch_add(1)) < count;)
+            {
+                try
+                {
+                    fn(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(batch.m_Mutex);
+                    if (!batch.m_pException)
+                    {
+                        batch.m_pException = std::current_exception();
+                    }
+                    batch.m_nNext = count;
+                }
+            }
+        };
+
+        const std::size_t jobs = std::min(count - 1, m_Workers.size());
+        batch.m_nPending = jobs;
+        if (jobs != 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                for (std::size_t j = 0; j < jobs; ++j)
+                {
+                    m_Jobs.emplace_back([&batch, &drain] {
+                        drain();
+                        std::lock_guard<std::mutex> lock(batch.m_Mutex);
+                        if (--batch.m_nPending == 0)
+                        {
+                            batch.m_Done.notify_all();
+                        }
+                    });
+                }
+            }
+            m_Wake.notify_all();
+        }
+
+        drain();
+        wait(batch);
+
+        if (batch.m_pException)
+        {
+            std::rethrow_exception(batch.m_pException);
+        }
+    }
+
+    // Pool shared by the parallel range operations, one worker per hardware thread besides the caller
+    static ThreadPool& instance()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    static std::size_t DefaultThreads()
+    {
+        const unsigned int n = std::thread::hardware_concurrency();
+        return n > 1 ? n - 1 : 0;
+    }
+
+private:
+    // state of one parallel_for, lives on the caller's stack until every job has finished
+    struct Batch
+    {
+        std::atomic<std::size_t> m_nNext{0};
+        std::size_t m_nPending = 0;
+        std::exception_ptr m_pException;
+        std::mutex m_Mutex;
+        std::condition_variable m_Done;
+    };
+
+    void work()
+    {
+        for (;;)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Wake.wait(lock, [this] { return m_bStop || !m_Jobs.empty(); });
+                if (m_Jobs.empty())
+                {
+                    return;
+                }
+                job = std::move(m_Jobs.front());
+                m_Jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    // Wait for the batch's jobs, running queued jobs while any of them has not started
+    void wait(Batch& batch)
+    {
+        for (;;)
+        {
+            {
+                std::lock_guard<std::mutex> lock(batch.m_Mutex);
+                if (batch.m_nPending == 0)
+                {
+                    return;
+                }
+            }
+
+            std::function<void()> job;
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (!m_Jobs.empty())
+                {
+                    job = std::move(m_Jobs.front());
+                    m_Jobs.pop_front();
+                }
+            }
+
+            if (job)
+            {
+                job();
+                continue;
+            }
+
+            // every remaining job of the batch is running on a worker
+            std::unique_lock<std::mutex> lock(batch.m_Mutex);
+            batch.m_Done.wait(lock, [&batch] { return batch.m_nPending == 0; });
+            return;
+        }
+    }
+
+    std::vector<std::thread> m_Workers;
+    std::deque<std::function<void()> > m_Jobs;
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    bool m_bStop = false;
+};
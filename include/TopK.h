@@ -0,0 +1,201 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "Fusion.h"
+#include "Parallel.h"
+
+// range | top_k(k, comp) is the k greatest elements of the range under comp, greatest first: what sorting
+// the range, reversing it and taking k gives, without sorting the rest of the input
+// The fused pipeline pushes every element into a heap bounded to k, whose least element is replaced when a
+// greater one arrives. That is O(n log k) time and O(k) memory in a single pass, so the range may be a
+// single-pass source such as lines(FileReader&). Which of several equal elements are kept is unspecified
+// top_k(par, range, k, comp) evaluates a splittable pipeline in chunks as Parallel.h does, with a heap per
+// chunk, and merges the heaps of the chunks into the result
+
+// clang-format off
+namespace Range
+{
+// clang-format on
+
+namespace detail {
+
+// The k greatest elements pushed so far
+// The heap is ordered on the reverse of comp, so its front is the least element kept
+template <typename T, typename Compare>
+class top_k_heap final
+{
+public:
+    top_k_heap(std::size_t k, Compare comp)
+        : m_nCount(k)
+        , m_comp(comp)
+    {
+    }
+
+    template <typename U>
+    void push(U&& value)
+    {
+        if (m_Heap.size() < m_nCount)
+        {
+            m_Heap.push_back(std::forward<U>(value));
+            std::push_heap(m_Heap.begin(), m_Heap.end(), greater());
+        }
+        else if (m_nCount != 0 && m_comp(m_Heap.front(), value))
+        {
+            std::pop_heap(m_Heap.begin(), m_Heap.end(), greater());
+            m_Heap.back() = std::forward<U>(value);
+            std::push_heap(m_Heap.begin(), m_Heap.end(), greater());
+        }
+    }
+
+    // The elements kept, in heap order
+    std::vector<T>& elements() { return m_Heap; }
+
+    // The elements kept, greatest first
+    std::vector<T> sorted()
+    {
+        std::sort_heap(m_Heap.begin(), m_Heap.end(), greater());
+        return std::move(m_Heap);
+    }
+
+private:
+    auto greater()
+    {
+        return [this](const T& lhs, const T& rhs) { return m_comp(rhs, lhs); };
+    }
+
+    std::size_t m_nCount;
+    Compare m_comp;
+    std::vector<T> m_Heap;
+};
+
+}  // namespace detail
+
+// The k greatest elements of the range under comp, greatest first
+template <typename Rng, typename Compare>
+std::vector<detail::range_value_t<Rng> > top_k(const Rng& range, std::size_t k, Compare comp)
+{
+    detail::top_k_heap<detail::range_value_t<Rng>, Compare> heap(k, comp);
+    if (k != 0)
+    {
+        auto sink = [&heap](auto&& value) {
+            heap.push(std::forward<decltype(value)>(value));
+            return true;
+        };
+        detail::fuse(range, sink);
+    }
+    return heap.sorted();
+}
+
+template <typename Rng>
+std::vector<detail::range_value_t<Rng> > top_k(const Rng& range, std::size_t k)
+{
+    return top_k(range, k, std::less<>());
+}
+
+// The k greatest elements of the range under comp, greatest first, evaluating chunks of the range in parallel
+// comp is copied per chunk and called from several threads at once
+template <typename Rng, typename Compare>
+std::vector<detail::range_value_t<Rng> > top_k(parallel_policy, const Rng& range, std::size_t k, Compare comp)
+{
+    using value_type = detail::range_value_t<Rng>;
+
+    if constexpr (!detail::parallel_splittable<Rng>::value)
+    {
+        return Range::top_k(range, k, comp);
+    }
+    else
+    {
+        if (k == 0)
+        {
+            return std::vector<value_type>();
+        }
+
+        const std::size_t chunks = detail::parallel_chunk_count(range);
+        std::vector<std::vector<value_type> > heaps(chunks);
+        detail::parallel_chunks(range, chunks, [&heaps, &comp, k](std::size_t chunk, auto run) {
+            detail::top_k_heap<value_type, Compare> heap(k, comp);
+            auto sink = [&heap](auto&& value) {
+                heap.push(std::forward<decltype(value)>(value));
+                return true;
+            };
+            run(sink);
+            heaps[chunk] = std::move(heap.elements());
+        });
+
+        // the k greatest of the whole range are among the k greatest of each chunk
+        detail::top_k_heap<value_type, Compare> heap(k, comp);
+        for (std::vector<value_type>& chunkHeap : heaps)
+        {
+            for (value_type& value : chunkHeap)
+            {
+                heap.push(std::move(value));
+            }
+        }
+        return heap.sorted();
+    }
+}
+
+template <typename Rng>
+std::vector<detail::range_value_t<Rng> > top_k(parallel_policy, const Rng& range, std::size_t k)
+{
+    return top_k(par, range, k, std::less<>());
+}
+
+template <typename Compare>
+class top_k_holder
+{
+public:
+    top_k_holder(std::size_t k, Compare comp)
+        : m_nCount(k)
+        , m_comp(comp)
+    {
+    }
+
+    std::size_t count() const { return m_nCount; }
+    const Compare& compare() const { return m_comp; }
+
+private:
+    std::size_t m_nCount;
+    Compare m_comp;
+};
+
+template <typename Compare>
+class parallel_top_k_holder : public top_k_holder<Compare>
+{
+public:
+    parallel_top_k_holder(std::size_t k, Compare comp)
+        : top_k_holder<Compare>(k, comp)
+    {
+    }
+};
+
+// Construct the top_k adaptor, range | top_k(k, comp)
+template <typename Compare = std::less<> >
+top_k_holder<Compare> top_k(std::size_t k, Compare comp = Compare())
+{
+    return top_k_holder<Compare>(k, comp);
+}
+
+// Construct the parallel top_k adaptor, range | top_k(par, k, comp)
+template <typename Compare = std::less<> >
+parallel_top_k_holder<Compare> top_k(parallel_policy, std::size_t k, Compare comp = Compare())
+{
+    return parallel_top_k_holder<Compare>(k, comp);
+}
+
+template <typename Rng, typename Compare>
+std::vector<detail::range_value_t<Rng> > operator|(const Rng& range, const top_k_holder<Compare>& holder)
+{
+    return top_k(range, holder.count(), holder.compare());
+}
+
+template <typename Rng, typename Compare>
+std::vector<detail::range_value_t<Rng> > operator|(const Rng& range, const parallel_top_k_holder<Compare>& holder)
+{
+    return top_k(par, range, holder.count(), holder.compare());
+}
+
+}  // namespace Range
@@ -1,6 +1,10 @@
 #pragma once
+#include <iterator>
+#include <type_traits>
+#include <utility>
 #include "IteratorTraits.h"
 #include "Range.h"
+#include "Sentinel.h"
 #include "View.h"
 
 // clang-format off
@@ -8,20 +12,81 @@ namespace Range
 {
 // clang-format on
 
+namespace detail {
+
+// Holds the operation of an adaptor iterator, an empty operation (a lambda without captures, a function
+// object) is an empty base and adds nothing to the size of the iterator
+template <typename Operation, bool = std::is_empty<Operation>::value && !std::is_final<Operation>::value>
+class operation_storage
+{
+public:
+    operation_storage() = default;
+
+    explicit operation_storage(Operation op)
+        : m_op(op)
+    {
+    }
+
+    operation_storage(const operation_storage&) = default;
+
+    // declared rather than defaulted so an iterator over a lambda, which cannot be assigned, is still
+    // CopyAssignable as far as the iterator traits can tell
+    operation_storage& operator=(const operation_storage& rhs)
+    {
+        m_op = rhs.m_op;
+        return *this;
+    }
+
+    // the non-const operation is called by operator*, so a mutable lambda or a non-const operator() works
+    Operation& operation() { return m_op; }
+    const Operation& operation() const { return m_op; }
+
+private:
+    Operation m_op{};
+};
+
+template <typename Operation>
+class operation_storage<Operation, true> : private Operation
+{
+public:
+    operation_storage() = default;
+
+    explicit operation_storage(Operation op)
+        : Operation(op)
+    {
+    }
+
+    operation_storage(const operation_storage&) = default;
+
+    // an empty operation has no state to assign
+    operation_storage& operator=(const operation_storage&) { return *this; }
+
+    Operation& operation() { return *this; }
+    const Operation& operation() const { return *this; }
+};
+
+}  // namespace detail
+
+// operator* applies the operation on every call and returns what it returns: a result returned by value is
+// a prvalue the caller moves from, a reference returned by the operation is passed through. Nothing is
+// cached, so value_type needs no default constructor and copying the iterator copies the base iterator and
+// the operation only
 template <typename BaseIterator, typename UnaryOperation>
-class transform_iterator final
+class transform_iterator final : private detail::operation_storage<UnaryOperation>
 {
     static_assert(is_input_iterator<BaseIterator>::value, "transform_iterator requires input iterator");
 
+    using storage = detail::operation_storage<UnaryOperation>;
+
 public:
     using iterator_category = typename std::iterator_traits<BaseIterator>::iterator_category;
-    using value_type = typename std::result_of<UnaryOperation(typename std::iterator_traits<BaseIterator>::value_type)>::type;
+    using reference = decltype(std::declval<UnaryOperation&>()(*std::declval<BaseIterator&>()));
+    using value_type = typename std::remove_cv<typename std::remove_reference<reference>::type>::type;
     using difference_type = typename std::iterator_traits<BaseIterator>::difference_type;
-    using pointer = value_type*;
-    using reference = const value_type&;
+    using pointer = typename std::add_pointer<typename std::remove_reference<reference>::type>::type;
 
     explicit transform_iterator(BaseIterator iterator, UnaryOperation op)
-        : m_op(op)
+        : storage(op)
         , m_iterator(iterator)
     {
     }
@@ -29,36 +94,19 @@ public:
     // Iterator requires CopyConstructible, CopyAssignable, Destructible
     ~transform_iterator() = default;
     transform_iterator(const transform_iterator&) = default;
-    transform_iterator& operator=(const transform_iterator& rhs)
-    {
-        m_op = rhs.m_op;
-        m_iterator = rhs.m_iterator;
-        m_result = rhs.m_result;
-        m_valid = rhs.m_valid;
-
-        return *this;
-    }
+    transform_iterator& operator=(const transform_iterator&) = default;
 
     transform_iterator& operator++()
     {
         ++m_iterator;
-        m_valid = false;
         return *this;
     }
 
     // Required by InputIterator
-    reference operator*()
-    {
-        if (!m_valid)
-        {
-            m_result = m_op(*m_iterator);
-            m_valid = true;
-        }
-        return m_result;
-    }
+    reference operator*() { return storage::operation()(*m_iterator); }
 
-    bool operator==(const transform_iterator& rhs) { return m_iterator == rhs.m_iterator; }
-    bool operator!=(const transform_iterator& rhs) { return m_iterator != rhs.m_iterator; }
+    bool operator==(const transform_iterator& rhs) const { return m_iterator == rhs.m_iterator; }
+    bool operator!=(const transform_iterator& rhs) const { return m_iterator != rhs.m_iterator; }
 
     // Required by ForwardIterator
     transform_iterator() = default;
@@ -74,7 +122,6 @@ public:
     transform_iterator& operator--()
     {
         --m_iterator;
-        m_valid = false;
         return *this;
     }
 
@@ -91,7 +138,6 @@ public:
     transform_iterator& operator+=(difference_type n)
     {
         m_iterator += n;
-        m_valid = false;
         return *this;
     }
 
@@ -123,23 +169,19 @@ public:
     difference_type operator-(const transform_iterator& rhs) { return m_iterator - rhs.m_iterator; }
 
     // a[n]
-    value_type operator[](size_t n) const { return m_op(*(m_iterator + n)); }
+    reference operator[](difference_type n) const { return storage::operation()(*(m_iterator + n)); }
 
     friend bool operator<(const transform_iterator& lhs, const transform_iterator& rhs) { return lhs.m_iterator < rhs.m_iterator; }
     friend bool operator>(const transform_iterator& lhs, const transform_iterator& rhs) { return rhs < lhs; }
     friend bool operator<=(const transform_iterator& lhs, const transform_iterator& rhs) { return !(rhs < lhs); }
     friend bool operator>=(const transform_iterator& lhs, const transform_iterator& rhs) { return !(lhs < rhs); }
 
-private:
-    UnaryOperation m_op{};
+    // Underlying iterator and operation, used by Fusion.h to run a pipeline over the innermost iterator
+    const BaseIterator& base() const { return m_iterator; }
+    using storage::operation;
 
+private:
     BaseIterator m_iterator{};
-
-    // cache the current result to allow operator* to return by reference
-    value_type m_result{};
-
-    // cache validation flag
-    bool m_valid = false;
 };
 
 template <typename BaseIterator, typename UnaryOperation>
@@ -181,4 +223,12 @@ auto operator|(const IteratorRange<Iterator>& range, unary_operation<UnaryOperat
     return make_range(make_transform_iterator(range.begin(), transformer.get()), make_transform_iterator(range.end(), transformer.get()));
 }
 
+// Construct view by applying transform adaptor to the sentinel range
+template <typename Iterator, typename Sentinel, typename UnaryOperation>
+auto operator|(const SentinelRange<Iterator, Sentinel>& range, unary_operation<UnaryOperation> transformer)
+    -> SentinelRange<transform_iterator<Iterator, UnaryOperation>, adaptor_sentinel<Sentinel> >
+{
+    return make_sentinel_range(make_transform_iterator(range.begin(), transformer.get()), adaptor_sentinel<Sentinel>(range.end()));
+}
+
 }  // namespace Range
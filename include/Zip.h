@@ -0,0 +1,470 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "Fusion.h"
+#include "IteratorTraits.h"
+#include "Range.h"
+#include "Sentinel.h"
+#include "SizeHint.h"
+
+// zip(a, b, ...) walks several ranges in lockstep, range | enumerate() pairs every element with its index
+// A zip_iterator is a tuple of the iterators of its ranges, and dereferencing it gives a tuple of what
+// they dereference to: references into the ranges, nothing is copied. When every range is random access
+// the zip is random access and ends after the shortest range, otherwise it is a forward range that ends
+// when any of its ranges does. A zip with a sentinel range among its ranges ends at a zip_sentinel, reached
+// when any of the ranges reaches its end
+// The zip keeps iterators into its ranges, so a container passed to zip must outlive it. A temporary
+// container is rejected, a temporary view such as v | take(3) is accepted since its iterators point into v
+// Fused evaluation drives a random-access zip with one index, so a zipped numeric loop compiles to the
+// same loop as the hand-written one over the vectors and vectorizes like it
+
+// clang-format off
+namespace Range
+{
+// clang-format on
+
+namespace detail {
+
+template <typename... Iterators>
+struct zip_random_access : std::integral_constant<bool, (is_random_access_iterator<Iterators>::value && ...)>
+{
+};
+
+}  // namespace detail
+
+// Position of a zip, the iterators of all its ranges advance together
+template <typename... Iterators>
+class zip_iterator final
+{
+    static_assert(sizeof...(Iterators) != 0, "zip requires at least one range");
+    static_assert((is_input_iterator<Iterators>::value && ...), "zip_iterator requires input iterators");
+
+    static constexpr bool random_access = detail::zip_random_access<Iterators...>::value;
+
+    using indices = std::index_sequence_for<Iterators...>;
+
+public:
+    using iterator_category = typename std::conditional<random_access, std::random_access_iterator_tag,
+                                                        typename std::conditional<(is_forward_iterator<Iterators>::value && ...),
+                                                                                  std::forward_iterator_tag, std::input_iterator_tag>::type>::type;
+    using value_type = std::tuple<typename std::iterator_traits<Iterators>::value_type...>;
+    using reference = std::tuple<decltype(*std::declval<Iterators&>())...>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+
+    explicit zip_iterator(Iterators... iterators)
+        : m_Iterators(iterators...)
+    {
+    }
+
+    // Iterator requires CopyConstructible, CopyAssignable, Destructible
+    ~zip_iterator() = default;
+    zip_iterator(const zip_iterator&) = default;
+    zip_iterator& operator=(const zip_iterator&) = default;
+
+    zip_iterator& operator++()
+    {
+        std::apply([](auto&... it) { (++it, ...); }, m_Iterators);
+        return *this;
+    }
+
+    // Required by InputIterator
+    reference operator*() { return dereference(indices()); }
+
+    // The end of a random-access zip is aligned with its begin, one component decides. Any other zip is at
+    // its end when any of its ranges is
+    bool operator==(const zip_iterator& rhs) const
+    {
+        if constexpr (random_access)
+        {
+            return std::get<0>(m_Iterators) == std::get<0>(rhs.m_Iterators);
+        }
+        else
+        {
+            return any_equal(rhs, indices());
+        }
+    }
+
+    bool operator!=(const zip_iterator& rhs) const { return !(*this == rhs); }
+
+    // Required by ForwardIterator
+    zip_iterator() = default;
+
+    zip_iterator operator++(int)
+    {
+        zip_iterator temp(*this);
+        ++(*this);
+        return temp;
+    }
+
+    // Required by BidirectionalIterator and RandomAccessIterator, when every range is random access
+    zip_iterator& operator--()
+    {
+        static_assert(random_access, "zip of ranges that are not all random access is a forward range");
+        std::apply([](auto&... it) { (--it, ...); }, m_Iterators);
+        return *this;
+    }
+
+    zip_iterator operator--(int)
+    {
+        zip_iterator temp(*this);
+        --(*this);
+        return temp;
+    }
+
+    // r += n
+    zip_iterator& operator+=(difference_type n)
+    {
+        static_assert(random_access, "zip of ranges that are not all random access is a forward range");
+        std::apply([n](auto&... it) { ((it += n), ...); }, m_Iterators);
+        return *this;
+    }
+
+    // a + n
+    zip_iterator operator+(difference_type n) const
+    {
+        zip_iterator temp(*this);
+        return temp += n;
+    }
+
+    // n + a
+    friend zip_iterator operator+(difference_type n, const zip_iterator& rhs) { return rhs + n; }
+
+    // r -= n
+    zip_iterator& operator-=(difference_type n) { return *this += -n; }
+
+    // a - n
+    zip_iterator operator-(difference_type n) const
+    {
+        zip_iterator temp(*this);
+        return temp -= n;
+    }
+
+    // b - a
+    difference_type operator-(const zip_iterator& rhs) const
+    {
+        return static_cast<difference_type>(std::get<0>(m_Iterators) - std::get<0>(rhs.m_Iterators));
+    }
+
+    // a[n]
+    reference operator[](difference_type n) const { return subscript(n, indices()); }
+
+    friend bool operator<(const zip_iterator& lhs, const zip_iterator& rhs) { return lhs - rhs < 0; }
+    friend bool operator>(const zip_iterator& lhs, const zip_iterator& rhs) { return rhs < lhs; }
+    friend bool operator<=(const zip_iterator& lhs, const zip_iterator& rhs) { return !(rhs < lhs); }
+    friend bool operator>=(const zip_iterator& lhs, const zip_iterator& rhs) { return !(lhs < rhs); }
+
+    // Iterators of the zipped ranges, used by Fusion.h to index them directly
+    const std::tuple<Iterators...>& base() const { return m_Iterators; }
+
+private:
+    template <std::size_t... Index>
+    reference dereference(std::index_sequence<Index...>)
+    {
+        return reference(*std::get<Index>(m_Iterators)...);
+    }
+
+    template <std::size_t... Index>
+    reference subscript(difference_type n, std::index_sequence<Index...>) const
+    {
+        return reference(std::get<Index>(m_Iterators)[n]...);
+    }
+
+    template <std::size_t... Index>
+    bool any_equal(const zip_iterator& rhs, std::index_sequence<Index...>) const
+    {
+        return ((std::get<Index>(m_Iterators) == std::get<Index>(rhs.m_Iterators)) || ...);
+    }
+
+    std::tuple<Iterators...> m_Iterators;
+};
+
+template <typename... Iterators>
+zip_iterator<Iterators...> make_zip_iterator(Iterators... iterators)
+{
+    static_assert(is_iterator<zip_iterator<Iterators...> >::value, "is_iterator failed");
+    return zip_iterator<Iterators...>(iterators...);
+}
+
+// End of a zip with a sentinel range among its ranges, holds the end of every range
+template <typename... Sentinels>
+class zip_sentinel final
+{
+public:
+    zip_sentinel() = default;
+
+    explicit zip_sentinel(Sentinels... ends)
+        : m_Ends(ends...)
+    {
+    }
+
+    const std::tuple<Sentinels...>& base() const { return m_Ends; }
+
+private:
+    std::tuple<Sentinels...> m_Ends;
+};
+
+template <typename... Sentinels>
+zip_sentinel<Sentinels...> make_zip_sentinel(Sentinels... ends)
+{
+    return zip_sentinel<Sentinels...>(ends...);
+}
+
+namespace detail {
+
+template <typename... Iterators, typename... Sentinels, std::size_t... Index>
+bool zip_any_at_end(const std::tuple<Iterators...>& iterators, const std::tuple<Sentinels...>& ends, std::index_sequence<Index...>)
+{
+    return ((std::get<Index>(iterators) == std::get<Index>(ends)) || ...);
+}
+
+}  // namespace detail
+
+// A zip is at its end when any of its ranges is
+template <typename... Iterators, typename... Sentinels>
+bool operator==(const zip_iterator<Iterators...>& it, const zip_sentinel<Sentinels...>& s)
+{
+    static_assert(sizeof...(Iterators) == sizeof...(Sentinels), "zip_sentinel has an end per range");
+    return detail::zip_any_at_end(it.base(), s.base(), std::index_sequence_for<Iterators...>());
+}
+
+template <typename... Iterators, typename... Sentinels>
+bool operator!=(const zip_iterator<Iterators...>& it, const zip_sentinel<Sentinels...>& s)
+{
+    return !(it == s);
+}
+
+// Random-access iterator over the indices 0, 1, 2, ..., dereferences to the index itself
+class index_iterator final
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::size_t;
+
+    explicit index_iterator(std::size_t index)
+        : m_nIndex(index)
+    {
+    }
+
+    // Iterator requires CopyConstructible, CopyAssignable, Destructible
+    ~index_iterator() = default;
+    index_iterator(const index_iterator&) = default;
+    index_iterator& operator=(const index_iterator&) = default;
+
+    index_iterator& operator++()
+    {
+        ++m_nIndex;
+        return *this;
+    }
+
+    // Required by InputIterator
+    reference operator*() const { return m_nIndex; }
+
+    bool operator==(const index_iterator& rhs) const { return m_nIndex == rhs.m_nIndex; }
+    bool operator!=(const index_iterator& rhs) const { return m_nIndex != rhs.m_nIndex; }
+
+    // Required by ForwardIterator
+    index_iterator() = default;
+
+    index_iterator operator++(int)
+    {
+        index_iterator temp(*this);
+        ++(*this);
+        return temp;
+    }
+
+    // Required by BidirectionalIterator
+    index_iterator& operator--()
+    {
+        --m_nIndex;
+        return *this;
+    }
+
+    index_iterator operator--(int)
+    {
+        index_iterator temp(*this);
+        --(*this);
+        return temp;
+    }
+
+    // Required by RandomAccessIterator
+    index_iterator& operator+=(difference_type n)
+    {
+        m_nIndex += n;
+        return *this;
+    }
+
+    index_iterator operator+(difference_type n) const { return index_iterator(m_nIndex + n); }
+    friend index_iterator operator+(difference_type n, const index_iterator& rhs) { return rhs + n; }
+    index_iterator& operator-=(difference_type n) { return *this += -n; }
+    index_iterator operator-(difference_type n) const { return index_iterator(m_nIndex - n); }
+    difference_type operator-(const index_iterator& rhs) const { return static_cast<difference_type>(m_nIndex - rhs.m_nIndex); }
+    reference operator[](difference_type n) const { return m_nIndex + n; }
+
+    friend bool operator<(const index_iterator& lhs, const index_iterator& rhs) { return lhs.m_nIndex < rhs.m_nIndex; }
+    friend bool operator>(const index_iterator& lhs, const index_iterator& rhs) { return rhs < lhs; }
+    friend bool operator<=(const index_iterator& lhs, const index_iterator& rhs) { return !(rhs < lhs); }
+    friend bool operator>=(const index_iterator& lhs, const index_iterator& rhs) { return !(lhs < rhs); }
+
+private:
+    std::size_t m_nIndex = 0;
+};
+
+namespace detail {
+
+template <typename Rng>
+using zip_range_iterator_t = typename std::decay<decltype(std::declval<Rng&>().begin())>::type;
+
+template <typename Rng>
+using zip_range_sentinel_t = typename std::decay<decltype(std::declval<Rng&>().end())>::type;
+
+// Whether every range ends at an iterator
+template <typename... Rngs>
+struct zip_common : std::integral_constant<bool, (std::is_same<zip_range_iterator_t<Rngs>, zip_range_sentinel_t<Rngs> >::value && ...)>
+{
+};
+
+// A zip keeps iterators into its ranges, which must outlive it: an lvalue, or a view over one
+template <typename Rng>
+struct zip_argument : std::integral_constant<bool, std::is_lvalue_reference<Rng>::value || is_view<typename std::decay<Rng>::type>::value>
+{
+};
+
+// A random-access zip is cut to its shortest range so that its end is a position it reaches
+template <typename... Rngs>
+auto make_zip_range(std::true_type /*common*/, std::true_type /*random access*/, Rngs&... ranges)
+    -> IteratorRange<zip_iterator<zip_range_iterator_t<Rngs>...> >
+{
+    std::ptrdiff_t size = std::numeric_limits<std::ptrdiff_t>::max();
+    ((size = std::min<std::ptrdiff_t>(size, static_cast<std::ptrdiff_t>(ranges.end() - ranges.begin()))), ...);
+    return make_range(make_zip_iterator(ranges.begin()...), make_zip_iterator((ranges.begin() + size)...));
+}
+
+template <typename... Rngs>
+auto make_zip_range(std::true_type /*common*/, std::false_type /*random access*/, Rngs&... ranges)
+    -> IteratorRange<zip_iterator<zip_range_iterator_t<Rngs>...> >
+{
+    return make_range(make_zip_iterator(ranges.begin()...), make_zip_iterator(ranges.end()...));
+}
+
+template <typename RandomAccess, typename... Rngs>
+auto make_zip_range(std::false_type /*common*/, RandomAccess, Rngs&... ranges)
+    -> SentinelRange<zip_iterator<zip_range_iterator_t<Rngs>...>, zip_sentinel<zip_range_sentinel_t<Rngs>...> >
+{
+    return make_sentinel_range(make_zip_iterator(ranges.begin()...), make_zip_sentinel(ranges.end()...));
+}
+
+// Fused evaluation of a zip, a random-access zip is driven by a counted loop over one index
+template <typename... Iterators>
+struct fusion_traits<zip_iterator<Iterators...> >
+{
+    using iterator = zip_iterator<Iterators...>;
+    using source_iterator = iterator;
+    static constexpr bool splittable = zip_random_access<Iterators...>::value;
+
+    static const iterator& source(const iterator& it) { return it; }
+
+    template <typename Last>
+    static const Last& source_end(const Last& last)
+    {
+        return last;
+    }
+
+    template <typename Last, typename Sink>
+    static void run_source(const iterator& /*pipeline*/, iterator first, const Last& last, Sink& sink)
+    {
+        if constexpr (splittable && std::is_same<Last, iterator>::value)
+        {
+            const std::ptrdiff_t size = last - first;
+            run_indexed(first.base(), size, sink, std::index_sequence_for<Iterators...>());
+        }
+        else
+        {
+            for (; first != last; ++first)
+            {
+                if (!sink(*first))
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    template <typename Last, typename Sink>
+    static void run(const iterator& first, const Last& last, Sink& sink)
+    {
+        run_source(first, first, last, sink);
+    }
+
+private:
+    template <typename Sink, std::size_t... Index>
+    static void run_indexed(const std::tuple<Iterators...>& iterators, std::ptrdiff_t size, Sink& sink, std::index_sequence<Index...>)
+    {
+        using reference = typename iterator::reference;
+        const std::tuple<Iterators...> first = iterators;
+        for (std::ptrdiff_t i = 0; i < size; ++i)
+        {
+            if (!sink(reference(std::get<Index>(first)[i]...)))
+            {
+                return;
+            }
+        }
+    }
+};
+
+}  // namespace detail
+
+// Construct view of the ranges in lockstep, the elements are tuples of references into the ranges
+template <typename... Rngs>
+auto zip(Rngs&&... ranges) -> decltype(detail::make_zip_range(detail::zip_common<Rngs...>(), detail::zip_random_access<detail::zip_range_iterator_t<Rngs>...>(), ranges...))
+{
+    static_assert((detail::zip_argument<Rngs>::value && ...), "zip of a temporary container would keep iterators into it past its end");
+    return detail::make_zip_range(detail::zip_common<Rngs...>(), detail::zip_random_access<detail::zip_range_iterator_t<Rngs>...>(), ranges...);
+}
+
+// clang-format off
+struct enumerator {};
+inline enumerator enumerate() { return enumerator{}; }
+// clang-format on
+
+// Construct view of (index, element) tuples
+// A range that is not random access gets an index range that never ends first, a sentinel range ends at a
+// zip_sentinel whose index end is unreachable. A temporary container is rejected as it is by zip
+template <typename Rng>
+auto operator|(Rng&& range, enumerator)
+{
+    static_assert(detail::zip_argument<Rng>::value, "enumerate of a temporary container would keep iterators into it past its end");
+    const auto& source = range;
+    using Iterator = typename std::decay<decltype(source.begin())>::type;
+    if constexpr (!std::is_same<Iterator, typename std::decay<decltype(source.end())>::type>::value)
+    {
+        return make_sentinel_range(make_zip_iterator(index_iterator(0), source.begin()), make_zip_sentinel(unreachable_sentinel(), source.end()));
+    }
+    else if constexpr (is_random_access_iterator<Iterator>::value)
+    {
+        const std::size_t size = static_cast<std::size_t>(source.end() - source.begin());
+        return make_range(make_zip_iterator(index_iterator(0), source.begin()), make_zip_iterator(index_iterator(size), source.end()));
+    }
+    else
+    {
+        return make_range(make_zip_iterator(index_iterator(0), source.begin()),
+                          make_zip_iterator(index_iterator(std::numeric_limits<std::size_t>::max()), source.end()));
+    }
+}
+
+// Construct view of (index, element) tuples, enumerate(range) is range | enumerate()
+template <typename Rng>
+auto enumerate(Rng&& range) -> decltype(std::forward<Rng>(range) | enumerate())
+{
+    return std::forward<Rng>(range) | enumerate();
+}
+
+}  // namespace Range